@@ -71,12 +71,98 @@ namespace polysolve
         return I;
     }
 
-    double extract_param(const std::string &key, const std::string &name, const json &json)
+    size_t sparsity_pattern_hash(const StiffnessMatrix &A)
     {
-        if (json.find(key) != json.end())
-            return json[key][name];
+        // boost::hash_combine
+        size_t seed = 0;
+        const auto combine = [&seed](const size_t v) {
+            seed ^= v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+        };
+
+        combine(A.rows());
+        combine(A.cols());
+        combine(A.nonZeros());
+        for (Eigen::Index k = 0; k < A.outerSize(); ++k)
+        {
+            size_t count = 0;
+            for (StiffnessMatrix::InnerIterator it(A, k); it; ++it, ++count)
+                combine(it.index());
+            combine(count);
+        }
+        return seed;
+    }
+
+    Eigen::MatrixXd rigid_body_modes(const Eigen::MatrixXd &V, const bool rotations_only)
+    {
+        const int dim = V.cols();
+        assert(dim == 2 || dim == 3);
+
+        const int n_translations = rotations_only ? 0 : dim;
+        const int n_rotations = dim == 2 ? 1 : 3;
+
+        // Rotate around the centroid for better conditioning
+        const Eigen::MatrixXd X = V.rowwise() - V.colwise().mean();
+
+        Eigen::MatrixXd B = Eigen::MatrixXd::Zero(V.rows() * dim, n_translations + n_rotations);
+        for (int i = 0; i < V.rows(); ++i)
+        {
+            for (int d = 0; d < n_translations; ++d)
+                B(i * dim + d, d) = 1;
+
+            if (dim == 2)
+            {
+                B(i * dim + 0, n_translations) = -X(i, 1);
+                B(i * dim + 1, n_translations) = X(i, 0);
+            }
+            else
+            {
+                // Rotation around x
+                B(i * dim + 1, n_translations + 0) = -X(i, 2);
+                B(i * dim + 2, n_translations + 0) = X(i, 1);
+                // Rotation around y
+                B(i * dim + 0, n_translations + 1) = X(i, 2);
+                B(i * dim + 2, n_translations + 1) = -X(i, 0);
+                // Rotation around z
+                B(i * dim + 0, n_translations + 2) = -X(i, 1);
+                B(i * dim + 1, n_translations + 2) = X(i, 0);
+            }
+        }
+
+        const Eigen::HouseholderQR<Eigen::MatrixXd> qr(B);
+        return qr.householderQ() * Eigen::MatrixXd::Identity(B.rows(), B.cols());
+    }
+
+    int split_translations(const Eigen::MatrixXd &B, Eigen::MatrixXd &others)
+    {
+        if (B.cols() == 0)
+            return 1;
+
+        const Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(B);
+        const int rank = qr.rank();
+        const Eigen::MatrixXd Q = qr.householderQ() * Eigen::MatrixXd::Identity(B.rows(), rank);
+
+        for (const int dim : {2, 3})
+        {
+            if (B.rows() % dim != 0 || rank < dim)
+                continue;
+
+            // Orthonormal translations
+            Eigen::MatrixXd T = Eigen::MatrixXd::Zero(B.rows(), dim);
+            for (int i = 0; i < B.rows(); ++i)
+                T(i, i % dim) = 1;
+            T /= std::sqrt(double(B.rows() / dim));
+
+            if ((T - Q * (Q.transpose() * T)).norm() > 1e-8)
+                continue;
+
+            // Complement of the translations in the span of B
+            const Eigen::MatrixXd R = Q - T * (T.transpose() * Q);
+            const Eigen::ColPivHouseholderQR<Eigen::MatrixXd> rqr(R);
+            others = rqr.householderQ() * Eigen::MatrixXd::Identity(B.rows(), rank - dim);
+            return dim;
+        }
 
-        return json[name];
+        return 1;
     }
 
 } // namespace polysolve
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #define POLYSOLVE_SCOPED_STOPWATCH(...) polysolve::StopWatch __polysolve_stopwatch(__VA_ARGS__)
 
 namespace polysolve
@@ -60,6 +64,53 @@ namespace polysolve
 
     Eigen::SparseMatrix<double> sparse_identity(int rows, int cols);
 
-    double extract_param(const std::string &key, const std::string &name, const json &json);
+    /// Fingerprint of the sparsity pattern (size, outer and inner indices) of a sparse matrix.
+    /// Two matrices with the same fingerprint can share the same symbolic factorization.
+    size_t sparsity_pattern_hash(const StiffnessMatrix &A);
+
+    /// Rigid body modes (translations, then rotations) of the vertices V (#V x dim, dim = 2 or 3),
+    /// for unknowns interleaved per vertex, as orthonormal columns.
+    /// With rotations_only the translations are omitted.
+    Eigen::MatrixXd rigid_body_modes(const Eigen::MatrixXd &V, const bool rotations_only = false);
+
+    /// Finds the number of unknowns per vertex (2 or 3) of an interleaved vector problem whose
+    /// translations are in the span of the near-nullspace B. The rest of the span of B is returned in
+    /// others as orthonormal columns. Returns 1 (and leaves others untouched) if there is none.
+    int split_translations(const Eigen::MatrixXd &B, Eigen::MatrixXd &others);
+
+    /// Parameter name of the solver key, or at the top level of json if there is no key section
+    template <typename T = double>
+    T extract_param(const std::string &key, const std::string &name, const json &json)
+    {
+        if (json.find(key) != json.end())
+            return json[key][name];
+
+        return json[name];
+    }
+
+    /// Calls func(begin, end) on contiguous chunks of [0, size) using up to num_threads threads,
+    /// with at least min_size_per_thread items per thread (serially below that).
+    template <typename Func>
+    void parallel_for(const int size, const int num_threads, const int min_size_per_thread, const Func &func)
+    {
+        const int n = std::max(1, std::min(num_threads, size / min_size_per_thread));
+        if (n == 1)
+        {
+            func(0, size);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(n);
+        const int chunk = (size + n - 1) / n;
+        for (int begin = 0; begin < size; begin += chunk)
+        {
+            threads.emplace_back(func, begin, std::min(begin + chunk, size));
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
 
 } // namespace polysolve
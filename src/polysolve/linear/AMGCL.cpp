@@ -5,6 +5,9 @@
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
+
+#include <chrono>
+#include <stdexcept>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polysolve::linear
@@ -90,6 +93,24 @@ namespace polysolve::linear
                 }
             }
         }
+
+        // AMGCL takes the parameters as a Boost property_tree (i.e., another JSON data structure)
+        boost::property_tree::ptree to_ptree(const json &params)
+        {
+            std::stringstream ss_params;
+            ss_params << params;
+            boost::property_tree::ptree pt_params;
+            boost::property_tree::read_json(ss_params, pt_params);
+            return pt_params;
+        }
+
+        void set_pmask(const int precond_num, const int num_rows, json &params)
+        {
+            std::vector<char> pmask(num_rows, 0);
+            for (size_t i = precond_num; i < num_rows; ++i)
+                pmask[i] = 1;
+            params["precond"]["pmask"] = pmask;
+        }
     } // namespace
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -97,6 +118,7 @@ namespace polysolve::linear
     AMGCL::AMGCL()
     {
         params_ = default_params();
+        pt_params_ = to_ptree(params_);
         // NOTE: usolver and psolver parameters are only used if the
         // preconditioner class is "schur_pressure_correction"
         precond_num_ = 0;
@@ -123,7 +145,14 @@ namespace polysolve::linear
                 return;
             }
 
+            if (params["AMGCL"].contains("rebuild_every"))
+            {
+                rebuild_every_ = params["AMGCL"]["rebuild_every"];
+            }
+
             set_params(params, params_);
+            pt_params_ = to_ptree(params_);
+            tol_solver_.reset();
         }
     }
 
@@ -141,6 +170,8 @@ namespace polysolve::linear
         }
         params["num_iterations"] = iterations_;
         params["final_res_norm"] = residual_error_;
+        params["rebuild"] = numeric_refresh_ ? "numeric" : "full";
+        params["setup_time"] = setup_time_;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -164,29 +195,87 @@ namespace polysolve::linear
         WrappedArray<StiffnessMatrix::StorageIndex> ia(Ain.outerIndexPtr(), numRows + 1);
         WrappedArray<StiffnessMatrix::StorageIndex> ja(Ain.innerIndexPtr(), Ain.nonZeros());
         WrappedArray<StiffnessMatrix::Scalar> a(Ain.valuePtr(), Ain.nonZeros());
+
+        // The mask depends on the matrix size, the other parameters are converted once in set_parameters
         if (params_["precond"]["class"] == "schur_pressure_correction")
         {
-            std::vector<char> pmask(numRows, 0);
-            for (size_t i = precond_num_; i < numRows; ++i)
-                pmask[i] = 1;
-            params_["precond"]["pmask"] = pmask;
+            set_pmask(precond_num_, numRows, params_);
+            pt_params_ = to_ptree(params_);
         }
 
-        // AMGCL takes the parameters as a Boost property_tree (i.e., another JSON data structure)
-        std::stringstream ss_params;
-        ss_params << params_;
-        boost::property_tree::ptree pt_params;
-        boost::property_tree::read_json(ss_params, pt_params);
         auto A = std::tie(numRows, ia, ja, a);
-        solver_ = std::make_unique<Solver>(A, pt_params);
+
+        const auto setup_start = std::chrono::steady_clock::now();
+
+        // Between full rebuilds, keep the coarsening of the previous hierarchy and only refresh the values
+        const bool can_rebuild = params_["precond"]["class"] == "amg" && rebuild_every_ > 1;
+        numeric_refresh_ = can_rebuild
+                           && solver_ != nullptr
+                           && solver_->size() == numRows
+                           && factorizations_since_rebuild_ + 1 < rebuild_every_;
+
+        // Only aggregation-based coarsenings use the nullspace
+        const bool use_nullspace = near_nullspace_.size() > 0
+                                   && params_["precond"]["class"] == "amg"
+                                   && params_["precond"]["coarsening"]["type"].get<std::string>().find("aggregation") != std::string::npos;
+        if (use_nullspace)
+        {
+            assert(near_nullspace_.rows() == numRows);
+            pt_params_.put("precond.coarsening.nullspace.cols", near_nullspace_.cols());
+            pt_params_.put("precond.coarsening.nullspace.rows", near_nullspace_.rows());
+            pt_params_.put("precond.coarsening.nullspace.B", near_nullspace_.data());
+        }
+
+        if (numeric_refresh_)
+        {
+            solver_->precond().rebuild(A);
+            ++factorizations_since_rebuild_;
+        }
+        else
+        {
+            // The transfer operators must be kept to refresh the hierarchy until the next full rebuild
+            if (can_rebuild)
+                pt_params_.put("precond.allow_rebuild", true);
+            solver_ = std::make_unique<Solver>(A, pt_params_);
+            tol_solver_.reset(); // the new solver already uses the tolerance in pt_params_
+            factorizations_since_rebuild_ = 0;
+        }
+        setup_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - setup_start).count();
         iterations_ = 0;
         residual_error_ = 0;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    void AMGCL::set_near_nullspace(const Eigen::MatrixXd &B)
+    {
+        // Block value types do not support a user-defined nullspace in AMGCL
+        if (block_size_ != 1)
+            throw std::runtime_error("[AMGCL] near-nullspace is not supported with block_size > 1");
+        near_nullspace_ = B;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
 
+    void AMGCL::set_tolerance(const double tol)
+    {
+        if (block_size_ == 2)
+        {
+            block2_solver_.set_tolerance(tol);
+            return;
+        }
+        else if (block_size_ == 3)
+        {
+            block3_solver_.set_tolerance(tol);
+            return;
+        }
+
+        pt_params_.put("solver.tol", tol);
+        // Only the Krylov solver depends on the tolerance, the preconditioner of solver_ is kept
+        if (solver_)
+            tol_solver_ = std::make_unique<IterativeSolver>(solver_->size(), pt_params_.get_child("solver"), backend_params_);
+    }
+
     void AMGCL::solve(const Eigen::Ref<const VectorXd> rhs, Eigen::Ref<VectorXd> result)
     {
         if (block_size_ == 2)
@@ -200,15 +289,44 @@ namespace polysolve::linear
             return;
         }
         assert(result.size() == rhs.size());
-        std::vector<double> _rhs(rhs.data(), rhs.data() + rhs.size());
-        std::vector<double> x(result.data(), result.data() + result.size());
-        auto rhs_b = Backend::copy_vector(_rhs, backend_params_);
-        auto x_b = Backend::copy_vector(x, backend_params_);
+        // The builtin backend works directly on the Eigen memory
+        auto rhs_b = amgcl::make_iterator_range(rhs.data(), rhs.data() + rhs.size());
+        auto x_b = amgcl::make_iterator_range(result.data(), result.data() + result.size());
 
         assert(solver_ != nullptr);
-        std::tie(iterations_, residual_error_) = (*solver_)(*rhs_b, *x_b);
+        if (tol_solver_)
+            std::tie(iterations_, residual_error_) = (*tol_solver_)(solver_->precond(), rhs_b, x_b);
+        else
+            std::tie(iterations_, residual_error_) = (*solver_)(rhs_b, x_b);
+    }
 
-        std::copy(&(*x_b)[0], &(*x_b)[0] + result.size(), result.data());
+    void AMGCL::solve(const Eigen::Ref<const Eigen::MatrixXd> rhs, Eigen::MatrixXd &result)
+    {
+        if (block_size_ == 2)
+        {
+            block2_solver_.solve(rhs, result);
+            return;
+        }
+        else if (block_size_ == 3)
+        {
+            block3_solver_.solve(rhs, result);
+            return;
+        }
+        if (result.rows() != rhs.rows() || result.cols() != rhs.cols())
+            result.setZero(rhs.rows(), rhs.cols());
+
+        size_t max_iterations = 0;
+        double max_residual_error = 0;
+        for (Eigen::Index j = 0; j < rhs.cols(); ++j)
+        {
+            solve(rhs.col(j), result.col(j));
+            max_iterations = std::max(max_iterations, iterations_);
+            max_residual_error = std::max(max_residual_error, residual_error_);
+        }
+
+        // Report the worst column
+        iterations_ = max_iterations;
+        residual_error_ = max_residual_error;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -221,6 +339,7 @@ namespace polysolve::linear
     AMGCL_Block<BLOCK_SIZE>::AMGCL_Block()
     {
         params_ = default_params();
+        pt_params_ = to_ptree(params_);
 
         // NOTE: usolver and psolver parameters are only used if the
         // preconditioner class is "schur_pressure_correction"
@@ -230,7 +349,14 @@ namespace polysolve::linear
     template <int BLOCK_SIZE>
     void AMGCL_Block<BLOCK_SIZE>::set_parameters(const json &params)
     {
+        if (params.contains("AMGCL") && params["AMGCL"].contains("rebuild_every"))
+        {
+            rebuild_every_ = params["AMGCL"]["rebuild_every"];
+        }
+
         set_params(params, params_);
+        pt_params_ = to_ptree(params_);
+        tol_solver_.reset();
     }
 
     template <int BLOCK_SIZE>
@@ -238,6 +364,8 @@ namespace polysolve::linear
     {
         params["num_iterations"] = iterations_;
         params["final_res_norm"] = residual_error_;
+        params["rebuild"] = numeric_refresh_ ? "numeric" : "full";
+        params["setup_time"] = setup_time_;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -253,48 +381,94 @@ namespace polysolve::linear
         WrappedArray<StiffnessMatrix::StorageIndex> ja(Ain.innerIndexPtr(), Ain.nonZeros());
         WrappedArray<StiffnessMatrix::Scalar> a(Ain.valuePtr(), Ain.nonZeros());
 
+        // The mask depends on the matrix size, the other parameters are converted once in set_parameters
         if (params_["precond"]["class"] == "schur_pressure_correction")
         {
-            std::vector<char> pmask(numRows, 0);
-            for (size_t i = precond_num_; i < numRows; ++i)
-                pmask[i] = 1;
-            params_["precond"]["pmask"] = pmask;
+            set_pmask(precond_num_, numRows, params_);
+            pt_params_ = to_ptree(params_);
         }
 
-        // AMGCL takes the parameters as a Boost property_tree (i.e., another JSON data structure)
-        std::stringstream ss_params;
-        ss_params << params_;
-        boost::property_tree::ptree pt_params;
-        boost::property_tree::read_json(ss_params, pt_params);
-
         auto A = std::tie(numRows, ia, ja, a);
         auto Ab = amgcl::adapter::block_matrix<dmat_type>(A);
-        solver_ = std::make_unique<Solver>(Ab, pt_params);
+
+        const auto setup_start = std::chrono::steady_clock::now();
+
+        // Between full rebuilds, keep the coarsening of the previous hierarchy and only refresh the values
+        const bool can_rebuild = params_["precond"]["class"] == "amg" && rebuild_every_ > 1;
+        numeric_refresh_ = can_rebuild
+                           && solver_ != nullptr
+                           && solver_->size() == numRows / BLOCK_SIZE
+                           && factorizations_since_rebuild_ + 1 < rebuild_every_;
+
+        if (numeric_refresh_)
+        {
+            solver_->precond().rebuild(Ab);
+            ++factorizations_since_rebuild_;
+        }
+        else
+        {
+            // The transfer operators must be kept to refresh the hierarchy until the next full rebuild
+            if (can_rebuild)
+                pt_params_.put("precond.allow_rebuild", true);
+            solver_ = std::make_unique<Solver>(Ab, pt_params_);
+            tol_solver_.reset(); // the new solver already uses the tolerance in pt_params_
+            factorizations_since_rebuild_ = 0;
+        }
+        setup_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - setup_start).count();
         iterations_ = 0;
         residual_error_ = 0;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
 
-    ////////////////////////////////////////////////////////////////////////////////
+    template <int BLOCK_SIZE>
+    void AMGCL_Block<BLOCK_SIZE>::set_tolerance(const double tol)
+    {
+        pt_params_.put("solver.tol", tol);
+        // Only the Krylov solver depends on the tolerance, the preconditioner of solver_ is kept
+        if (solver_)
+            tol_solver_ = std::make_unique<IterativeSolver>(solver_->size(), pt_params_.get_child("solver"), backend_params_);
+    }
 
     template <int BLOCK_SIZE>
     void AMGCL_Block<BLOCK_SIZE>::solve(const Eigen::Ref<const VectorXd> rhs, Eigen::Ref<VectorXd> result)
     {
         assert(result.size() == rhs.size());
-        std::vector<double> _rhs(rhs.data(), rhs.data() + rhs.size());
-        std::vector<double> x(result.data(), result.data() + result.size());
+        assert(rhs.size() % BLOCK_SIZE == 0);
 
-        auto rhs_b = amgcl::backend::reinterpret_as_rhs<dmat_type>(_rhs);
-        auto x_b = amgcl::backend::reinterpret_as_rhs<dmat_type>(x);
+        // View the Eigen memory as block vectors, the solution is written in place
+        using rhs_type = typename amgcl::math::rhs_of<dmat_type>::type;
+        const size_t n = rhs.size() / BLOCK_SIZE;
+        const rhs_type *rhs_ptr = reinterpret_cast<const rhs_type *>(rhs.data());
+        rhs_type *x_ptr = reinterpret_cast<rhs_type *>(result.data());
+        auto rhs_b = amgcl::make_iterator_range(rhs_ptr, rhs_ptr + n);
+        auto x_b = amgcl::make_iterator_range(x_ptr, x_ptr + n);
 
         assert(solver_ != nullptr);
-        std::tie(iterations_, residual_error_) = (*solver_)(rhs_b, x_b);
-        for (size_t i = 0; i < rhs.size() / BLOCK_SIZE; i++)
-            for (size_t j = 0; j < BLOCK_SIZE; j++)
-            {
-                result[BLOCK_SIZE * i + j] = x_b[i](j);
-            }
+        if (tol_solver_)
+            std::tie(iterations_, residual_error_) = (*tol_solver_)(solver_->precond(), rhs_b, x_b);
+        else
+            std::tie(iterations_, residual_error_) = (*solver_)(rhs_b, x_b);
+    }
+
+    template <int BLOCK_SIZE>
+    void AMGCL_Block<BLOCK_SIZE>::solve(const Eigen::Ref<const Eigen::MatrixXd> rhs, Eigen::MatrixXd &result)
+    {
+        if (result.rows() != rhs.rows() || result.cols() != rhs.cols())
+            result.setZero(rhs.rows(), rhs.cols());
+
+        size_t max_iterations = 0;
+        double max_residual_error = 0;
+        for (Eigen::Index j = 0; j < rhs.cols(); ++j)
+        {
+            solve(rhs.col(j), result.col(j));
+            max_iterations = std::max(max_iterations, iterations_);
+            max_residual_error = std::max(max_residual_error, residual_error_);
+        }
+
+        // Report the worst column
+        iterations_ = max_iterations;
+        residual_error_ = max_residual_error;
     }
 
     template <int BLOCK_SIZE>
@@ -30,6 +30,7 @@
 #include <amgcl/adapter/eigen.hpp>
 #include <amgcl/adapter/block_matrix.hpp>
 #include <amgcl/profiler.hpp>
+#include <boost/property_tree/ptree.hpp>
 #include <memory>
 #include <type_traits>
 
@@ -73,26 +74,41 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &A) override;
 
+        // Set the relative residual tolerance of the next solves, keeping the preconditioner
+        virtual void set_tolerance(const double tol) override;
+
         // Solve the linear system Ax = b
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
 
+        // Solve the linear system AX = B, reusing the hierarchy for all columns
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
+
         // Name of the solver type (for debugging purposes)
         virtual std::string name() const override { return "AMGCL_Block" + std::to_string(BLOCK_SIZE); }
 
     private:
         typedef amgcl::static_matrix<double, BLOCK_SIZE, BLOCK_SIZE> dmat_type; // matrix value type in double precision
         using Backend = amgcl::backend::builtin<dmat_type>;
+        using IterativeSolver = amgcl::runtime::solver::wrapper<Backend>;
         using Solver = amgcl::make_solver<
             amgcl::runtime::preconditioner<Backend>,
-            amgcl::runtime::solver::wrapper<Backend>>;
+            IterativeSolver>;
         std::unique_ptr<Solver> solver_;
+        std::unique_ptr<IterativeSolver> tol_solver_; // Krylov solver of set_tolerance, with the preconditioner of solver_
         json params_;
+        boost::property_tree::ptree pt_params_; // params_ converted for AMGCL
         typename Backend::params backend_params_;
         int precond_num_;
 
+        // Full hierarchy rebuild every rebuild_every_ factorizations, numeric refresh otherwise
+        int rebuild_every_ = 1;
+        int factorizations_since_rebuild_ = 0;
+
         // Output info
         size_t iterations_;
         double residual_error_;
+        bool numeric_refresh_ = false;
+        double setup_time_ = 0;
     };
 
     class AMGCL : public Solver
@@ -135,26 +151,47 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &A) override;
 
+        // Set the near-nullspace used by (smoothed) aggregation coarsening, throws for block size > 1
+        virtual void set_near_nullspace(const Eigen::MatrixXd &B) override;
+
+        // Set the relative residual tolerance of the next solves, keeping the preconditioner
+        virtual void set_tolerance(const double tol) override;
+
         // Solve the linear system Ax = b
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
 
+        // Solve the linear system AX = B, reusing the hierarchy for all columns
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
+
         // Name of the solver type (for debugging purposes)
         virtual std::string name() const override { return "AMGCL"; }
 
     private:
         using Backend = amgcl::backend::builtin<double>;
+        using IterativeSolver = amgcl::runtime::solver::wrapper<Backend>;
         using Solver = amgcl::make_solver<
             amgcl::runtime::preconditioner<Backend>,
-            amgcl::runtime::solver::wrapper<Backend>>;
+            IterativeSolver>;
         std::unique_ptr<Solver> solver_;
+        std::unique_ptr<IterativeSolver> tol_solver_; // Krylov solver of set_tolerance, with the preconditioner of solver_
         json params_;
+        boost::property_tree::ptree pt_params_; // params_ converted for AMGCL
         typename Backend::params backend_params_;
         int precond_num_;
         int block_size_ = 1;
 
+        // Near-nullspace vectors, stored row-major as expected by AMGCL
+        Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> near_nullspace_;
+
+        // Full hierarchy rebuild every rebuild_every_ factorizations, numeric refresh otherwise
+        int rebuild_every_ = 1;
+        int factorizations_since_rebuild_ = 0;
+
         // Output info
         size_t iterations_;
         double residual_error_;
+        bool numeric_refresh_ = false;
+        double setup_time_ = 0;
 
         AMGCL_Block<2> block2_solver_;
         AMGCL_Block<3> block3_solver_;
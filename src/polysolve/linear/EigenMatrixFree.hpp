@@ -0,0 +1,177 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+#include "LinearOperator.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <Eigen/Sparse>
+
+#include <vector>
+////////////////////////////////////////////////////////////////////////////////
+//
+// Wraps a LinearOperator so that Eigen's iterative solvers can use it in place of
+// a sparse matrix, see https://eigen.tuxfamily.org/dox/group__MatrixfreeSolverExample.html
+//
+
+namespace polysolve::linear
+{
+    class MatrixFreeOperator;
+}
+
+namespace Eigen::internal
+{
+    template <>
+    struct traits<polysolve::linear::MatrixFreeOperator> : public traits<polysolve::StiffnessMatrix>
+    {
+    };
+} // namespace Eigen::internal
+
+namespace polysolve::linear
+{
+    // -----------------------------------------------------------------------------
+
+    class MatrixFreeOperator : public Eigen::EigenBase<MatrixFreeOperator>
+    {
+    public:
+        typedef double Scalar;
+        typedef double RealScalar;
+        typedef StiffnessMatrix::StorageIndex StorageIndex;
+        enum
+        {
+            ColsAtCompileTime = Eigen::Dynamic,
+            MaxColsAtCompileTime = Eigen::Dynamic,
+            IsRowMajor = false
+        };
+
+        Eigen::Index rows() const { return op_ ? op_->rows() : 0; }
+        Eigen::Index cols() const { return rows(); }
+
+        template <typename Rhs>
+        Eigen::Product<MatrixFreeOperator, Rhs, Eigen::AliasFreeProduct> operator*(const Eigen::MatrixBase<Rhs> &x) const
+        {
+            return Eigen::Product<MatrixFreeOperator, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
+        }
+
+        // The operator must outlive the solves using this wrapper
+        void attach(const LinearOperator &op) { op_ = &op; }
+        const LinearOperator &op() const { return *op_; }
+
+    private:
+        const LinearOperator *op_ = nullptr;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // (Block-)Jacobi preconditioner of a MatrixFreeOperator, using whatever (block-)diagonal
+    // the operator provides, and the identity if it provides none
+    class MatrixFreePreconditioner
+    {
+    public:
+        MatrixFreePreconditioner() = default;
+
+        template <typename MatType>
+        explicit MatrixFreePreconditioner(const MatType &mat) { compute(mat); }
+
+        Eigen::Index rows() const { return size_; }
+        Eigen::Index cols() const { return size_; }
+
+        MatrixFreePreconditioner &analyzePattern(const MatrixFreeOperator &) { return *this; }
+
+        MatrixFreePreconditioner &factorize(const MatrixFreeOperator &mat)
+        {
+            const LinearOperator &op = mat.op();
+            size_ = op.rows();
+            inv_diag_.resize(0);
+            inv_blocks_.clear();
+
+            const int bs = op.block_size();
+            Eigen::MatrixXd blocks;
+            if (bs > 1 && op.block_diagonal(blocks))
+            {
+                inv_blocks_.reserve(size_ / bs);
+                for (Eigen::Index i = 0; i < size_; i += bs)
+                    inv_blocks_.push_back(blocks.middleRows(i, bs).fullPivLu().inverse());
+            }
+            else if (op.diagonal(inv_diag_))
+            {
+                for (Eigen::Index i = 0; i < inv_diag_.size(); ++i)
+                    inv_diag_[i] = inv_diag_[i] != 0 ? (1 / inv_diag_[i]) : 1;
+            }
+            return *this;
+        }
+
+        MatrixFreePreconditioner &compute(const MatrixFreeOperator &mat) { return factorize(mat); }
+
+        template <typename Rhs>
+        Eigen::VectorXd solve(const Eigen::MatrixBase<Rhs> &b) const
+        {
+            if (!inv_blocks_.empty())
+            {
+                const Eigen::Index bs = inv_blocks_.front().rows();
+                Eigen::VectorXd x(b.rows());
+                for (size_t i = 0; i < inv_blocks_.size(); ++i)
+                    x.segment(i * bs, bs).noalias() = inv_blocks_[i] * b.segment(i * bs, bs);
+                return x;
+            }
+            if (inv_diag_.size() > 0)
+                return inv_diag_.cwiseProduct(b);
+            return b;
+        }
+
+        Eigen::ComputationInfo info() { return Eigen::Success; }
+
+    private:
+        Eigen::Index size_ = 0;
+        Eigen::VectorXd inv_diag_;
+        std::vector<Eigen::MatrixXd> inv_blocks_;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Matrix-free version of an Eigen iterative solver on StiffnessMatrix, if any
+    template <typename SparseSolver>
+    struct MatrixFreeSolver
+    {
+        static constexpr bool available = false;
+        struct type
+        {
+        };
+    };
+
+    template <template <class, class> class SolverType, typename Precond>
+    struct MatrixFreeSolver<SolverType<StiffnessMatrix, Precond>>
+    {
+        static constexpr bool available = true;
+        typedef SolverType<MatrixFreeOperator, MatrixFreePreconditioner> type;
+    };
+
+    template <template <class, int, class> class SolverType, int UpLo, typename Precond>
+    struct MatrixFreeSolver<SolverType<StiffnessMatrix, UpLo, Precond>>
+    {
+        static constexpr bool available = true;
+        // Only full products are available without the matrix
+        typedef SolverType<MatrixFreeOperator, Eigen::Lower | Eigen::Upper, MatrixFreePreconditioner> type;
+    };
+
+} // namespace polysolve::linear
+
+namespace Eigen::internal
+{
+    template <typename Rhs>
+    struct generic_product_impl<polysolve::linear::MatrixFreeOperator, Rhs, SparseShape, DenseShape, GemvProduct>
+        : generic_product_impl_base<polysolve::linear::MatrixFreeOperator, Rhs,
+                                    generic_product_impl<polysolve::linear::MatrixFreeOperator, Rhs>>
+    {
+        typedef typename Product<polysolve::linear::MatrixFreeOperator, Rhs>::Scalar Scalar;
+
+        template <typename Dest>
+        static void scaleAndAddTo(Dest &dst, const polysolve::linear::MatrixFreeOperator &lhs, const Rhs &rhs, const Scalar &alpha)
+        {
+            const Eigen::VectorXd x = rhs;
+            Eigen::VectorXd y(lhs.rows());
+            lhs.op().apply(x, y);
+            dst.noalias() += alpha * y;
+        }
+    };
+} // namespace Eigen::internal
@@ -2,6 +2,7 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 #include "Solver.hpp"
+#include "EigenMatrixFree.hpp"
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polysolve::linear
@@ -36,8 +37,14 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &K) override;
 
+        // Factorize K + sigma I, if the solver supports shifts (simplicial and Cholmod Cholesky)
+        virtual bool refactorize_shifted(const StiffnessMatrix &K, const double sigma) override;
+
         // Solve the linear system
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
+
+        // Solve the linear system for multiple right-hand sides
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
     };
 
     // -----------------------------------------------------------------------------
@@ -49,6 +56,11 @@ namespace polysolve::linear
         // Solver class
         SparseSolver m_Solver;
 
+        // Same solver on a LinearOperator, used after factorize_operator
+        typename MatrixFreeSolver<SparseSolver>::type m_MatrixFreeSolver;
+        MatrixFreeOperator m_Operator;
+        bool m_IsMatrixFree = false;
+
         // Name of the solver
         std::string m_Name;
 
@@ -72,8 +84,18 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &K) override;
 
+        // If the solver has a matrix-free version
+        virtual bool supports_matrix_free() const override { return MatrixFreeSolver<SparseSolver>::available; }
+
+        // Setup the matrix-free solver, preconditioned with the (block-)diagonal of the operator if it has one
+        virtual void factorize_operator(const LinearOperator &A) override;
+
+        // Set the relative residual tolerance of the next solves
+        virtual void set_tolerance(const double tol) override;
+
         // Solve the linear system
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
+        using Solver::solve;
     };
 
     // -----------------------------------------------------------------------------
@@ -111,6 +133,9 @@ namespace polysolve::linear
 
         // Solve the linear system
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
+
+        // Solve the linear system for multiple right-hand sides
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
     };
 
     // -----------------------------------------------------------------------------
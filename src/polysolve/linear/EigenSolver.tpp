@@ -3,8 +3,26 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "EigenSolver.hpp"
 #include <iostream>
+#include <type_traits>
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace polysolve::linear
+{
+    namespace internal
+    {
+        // Whether the numeric factorization of SparseSolver can add a diagonal shift (setShift)
+        template <typename SparseSolver, typename = void>
+        struct has_shift : std::false_type
+        {
+        };
+
+        template <typename SparseSolver>
+        struct has_shift<SparseSolver, std::void_t<decltype(std::declval<SparseSolver &>().setShift(0.0))>> : std::true_type
+        {
+        };
+    } // namespace internal
+} // namespace polysolve::linear
+
 ////////////////////////////////////////////////////////////////////////////////
 // Direct solvers
 ////////////////////////////////////////////////////////////////////////////////
@@ -51,6 +69,27 @@ namespace polysolve::linear
         }
     }
 
+    // Factorize system matrix shifted by sigma I
+    template <typename SparseSolver>
+    bool EigenDirect<SparseSolver>::refactorize_shifted(const StiffnessMatrix &A, const double sigma)
+    {
+        if constexpr (internal::has_shift<SparseSolver>::value)
+        {
+            m_Solver.setShift(sigma);
+            m_Solver.factorize(A);
+            m_Solver.setShift(0);
+            if (m_Solver.info() == Eigen::NumericalIssue)
+            {
+                throw std::runtime_error("[EigenDirect] NumericalIssue encountered.");
+            }
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
     // Solve the linear system
     template <typename SparseSolver>
     void EigenDirect<SparseSolver>::solve(
@@ -59,6 +98,14 @@ namespace polysolve::linear
         x = m_Solver.solve(b);
     }
 
+    // Solve the linear system for multiple right-hand sides
+    template <typename SparseSolver>
+    void EigenDirect<SparseSolver>::solve(
+        const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X)
+    {
+        X = m_Solver.solve(B);
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // Iterative solvers
     ////////////////////////////////////////////////////////////////////////////////
@@ -73,18 +120,38 @@ namespace polysolve::linear
             if (params[solver_name].contains("max_iter"))
             {
                 m_Solver.setMaxIterations(params[solver_name]["max_iter"]);
+                if constexpr (MatrixFreeSolver<SparseSolver>::available)
+                    m_MatrixFreeSolver.setMaxIterations(params[solver_name]["max_iter"]);
             }
             if (params[solver_name].contains("tolerance"))
             {
-                m_Solver.setTolerance(params[solver_name]["tolerance"]);
+                set_tolerance(params[solver_name]["tolerance"]);
             }
         }
     }
 
+    // Set the relative residual tolerance of the next solves
+    template <typename SparseSolver>
+    void EigenIterative<SparseSolver>::set_tolerance(const double tol)
+    {
+        m_Solver.setTolerance(tol);
+        if constexpr (MatrixFreeSolver<SparseSolver>::available)
+            m_MatrixFreeSolver.setTolerance(tol);
+    }
+
     // Get info on the last solve step
     template <typename SparseSolver>
     void EigenIterative<SparseSolver>::get_info(json &params) const
     {
+        if constexpr (MatrixFreeSolver<SparseSolver>::available)
+        {
+            if (m_IsMatrixFree)
+            {
+                params["solver_iter"] = m_MatrixFreeSolver.iterations();
+                params["solver_error"] = m_MatrixFreeSolver.error();
+                return;
+            }
+        }
         params["solver_iter"] = m_Solver.iterations();
         params["solver_error"] = m_Solver.error();
     }
@@ -101,6 +168,23 @@ namespace polysolve::linear
     void EigenIterative<SparseSolver>::factorize(const StiffnessMatrix &A)
     {
         m_Solver.factorize(A);
+        m_IsMatrixFree = false;
+    }
+
+    // Setup the matrix-free solver
+    template <typename SparseSolver>
+    void EigenIterative<SparseSolver>::factorize_operator(const LinearOperator &A)
+    {
+        if constexpr (MatrixFreeSolver<SparseSolver>::available)
+        {
+            m_Operator.attach(A);
+            m_MatrixFreeSolver.compute(m_Operator);
+            m_IsMatrixFree = true;
+        }
+        else
+        {
+            Solver::factorize_operator(A);
+        }
     }
 
     // Solve the linear system
@@ -109,6 +193,14 @@ namespace polysolve::linear
         const Ref<const VectorXd> b, Ref<VectorXd> x)
     {
         assert(x.size() == b.size());
+        if constexpr (MatrixFreeSolver<SparseSolver>::available)
+        {
+            if (m_IsMatrixFree)
+            {
+                x = m_MatrixFreeSolver.solveWithGuess(b, x);
+                return;
+            }
+        }
         x = m_Solver.solveWithGuess(b, x);
     }
 
@@ -143,4 +235,12 @@ namespace polysolve::linear
     {
         x = m_Solver.solve(b);
     }
+
+    // Solve the linear system for multiple right-hand sides
+    template <typename DenseSolver>
+    void EigenDenseSolver<DenseSolver>::solve(
+        const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X)
+    {
+        X = m_Solver.solve(B);
+    }
 } // namespace polysolve::linear
@@ -3,8 +3,15 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "HypreSolver.hpp"
 
+#include <polysolve/Utils.hpp>
+
 #include <HYPRE_krylov.h>
 #include <HYPRE_utilities.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polysolve::linear
@@ -51,6 +58,10 @@ namespace polysolve::linear
             {
                 conv_tol_ = params["Hypre"]["tolerance"];
             }
+            if (params["Hypre"].contains("amg_reuse"))
+            {
+                amg_reuse_ = params["Hypre"]["amg_reuse"];
+            }
         }
     }
 
@@ -58,50 +69,7 @@ namespace polysolve::linear
     {
         params["num_iterations"] = num_iterations;
         params["final_res_norm"] = final_res_norm;
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////
-
-    void HypreSolver::factorize(const StiffnessMatrix &Ain)
-    {
-        assert(precond_num_ > 0);
-
-        if (has_matrix_)
-        {
-            HYPRE_IJMatrixDestroy(A);
-            has_matrix_ = false;
-        }
-
-        has_matrix_ = true;
-        const HYPRE_Int rows = Ain.rows();
-        const HYPRE_Int cols = Ain.cols();
-#ifdef HYPRE_WITH_MPI
-        HYPRE_IJMatrixCreate(MPI_COMM_WORLD, 0, rows - 1, 0, cols - 1, &A);
-#else
-        HYPRE_IJMatrixCreate(0, 0, rows - 1, 0, cols - 1, &A);
-#endif
-        // HYPRE_IJMatrixSetPrintLevel(A, 2);
-        HYPRE_IJMatrixSetObjectType(A, HYPRE_PARCSR);
-        HYPRE_IJMatrixInitialize(A);
-
-        // HYPRE_IJMatrixSetValues(A, 1, &nnz, &i, cols, values);
-
-        // TODO: More efficient initialization of the Hypre matrix?
-        for (HYPRE_Int k = 0; k < Ain.outerSize(); ++k)
-        {
-            for (StiffnessMatrix::InnerIterator it(Ain, k); it; ++it)
-            {
-                const HYPRE_Int i[1] = {it.row()};
-                const HYPRE_Int j[1] = {it.col()};
-                const HYPRE_Complex v[1] = {it.value()};
-                HYPRE_Int n_cols[1] = {1};
-
-                HYPRE_IJMatrixSetValues(A, 1, n_cols, i, j, v);
-            }
-        }
-
-        HYPRE_IJMatrixAssemble(A);
-        HYPRE_IJMatrixGetObject(A, (void **)&parcsr_A);
+        params["amg_reused"] = amg_reuse_count_ > 0;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -175,95 +143,365 @@ namespace polysolve::linear
             // HYPRE_BoomerAMGSetSmoothInterpVectors(amg_precond, smooth_interp_vectors);
             // HYPRE_BoomerAMGSetInterpRefine(amg_precond, interp_refine);
 
-            // RecomputeRBMs();
-            // HYPRE_BoomerAMGSetInterpVectors(amg_precond, rbms.Size(), rbms.GetData());
+            // The rigid body modes are set with HYPRE_BoomerAMGSetInterpVectors in factorize, when available
         }
 
-    } // anonymous namespace
-
-    ////////////////////////////////////////////////////////////////////////////////
-
-    void HypreSolver::solve(const Eigen::Ref<const VectorXd> rhs, Eigen::Ref<VectorXd> result)
-    {
-        HYPRE_IJVector b;
-        HYPRE_ParVector par_b;
-        HYPRE_IJVector x;
-        HYPRE_ParVector par_x;
-
+        void HypreIJVector_Create(const HYPRE_Int size, HYPRE_IJVector &v)
+        {
 #ifdef HYPRE_WITH_MPI
-        HYPRE_IJVectorCreate(MPI_COMM_WORLD, 0, rhs.size() - 1, &b);
+            HYPRE_IJVectorCreate(MPI_COMM_WORLD, 0, size - 1, &v);
 #else
-        HYPRE_IJVectorCreate(0, 0, rhs.size() - 1, &b);
+            HYPRE_IJVectorCreate(0, 0, size - 1, &v);
 #endif
-        HYPRE_IJVectorSetObjectType(b, HYPRE_PARCSR);
-        HYPRE_IJVectorInitialize(b);
+            HYPRE_IJVectorSetObjectType(v, HYPRE_PARCSR);
+            HYPRE_IJVectorInitialize(v);
+        }
+
+        void HypreBoomerAMG_Create(const int dimension, HYPRE_Solver &precond)
+        {
+            HYPRE_BoomerAMGCreate(&precond);
+
+            HypreBoomerAMG_SetDefaultOptions(precond);
+            if (dimension > 1)
+            {
+                HypreBoomerAMG_SetElasticityOptions(precond, dimension);
+            }
+        }
+
+        // Used in place of HYPRE_BoomerAMGSetup to keep the hierarchy of a previous matrix
+        HYPRE_Int HypreBoomerAMG_SkipSetup(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector)
+        {
+            return 0;
+        }
+
+        void HyprePCG_Create(const int max_iter, const double conv_tol, HYPRE_Solver &solver)
+        {
+            /* Create solver */
 #ifdef HYPRE_WITH_MPI
-        HYPRE_IJVectorCreate(MPI_COMM_WORLD, 0, rhs.size() - 1, &x);
+            HYPRE_ParCSRPCGCreate(MPI_COMM_WORLD, &solver);
 #else
-        HYPRE_IJVectorCreate(0, 0, rhs.size() - 1, &x);
+            HYPRE_ParCSRPCGCreate(0, &solver);
 #endif
-        HYPRE_IJVectorSetObjectType(x, HYPRE_PARCSR);
-        HYPRE_IJVectorInitialize(x);
 
-        assert(result.size() == rhs.size());
+            /* Set some parameters (See Reference Manual for more parameters) */
+            HYPRE_PCGSetMaxIter(solver, max_iter); /* max iterations */
+            HYPRE_PCGSetTol(solver, conv_tol);     /* conv. tolerance */
+            HYPRE_PCGSetTwoNorm(solver, 1);        /* use the two norm as the stopping criteria */
+            // HYPRE_PCGSetPrintLevel(solver, 2); /* print solve info */
+            HYPRE_PCGSetLogging(solver, 1); /* needed to get run info later */
+        }
+
+
+        // Minimum number of columns or rows per thread, below this the conversion runs serially
+        constexpr int MIN_SIZE_PER_THREAD = 4096;
 
-        for (HYPRE_Int i = 0; i < rhs.size(); ++i)
+        int num_threads()
         {
-            const HYPRE_Int index[1] = {i};
-            const HYPRE_Complex v[1] = {HYPRE_Complex(rhs(i))};
-            const HYPRE_Complex z[1] = {HYPRE_Complex(result(i))};
+            return std::max(1, int(std::thread::hardware_concurrency()));
+        }
 
-            HYPRE_IJVectorSetValues(b, 1, index, v);
-            HYPRE_IJVectorSetValues(x, 1, index, z);
+        // Whether A equals its transpose, looking up the mirror of every entry in the sorted columns of A
+        bool is_symmetric(const StiffnessMatrix &A)
+        {
+            assert(A.isCompressed());
+            const auto *outer = A.outerIndexPtr();
+            const auto *inner = A.innerIndexPtr();
+            const auto *values = A.valuePtr();
+
+            std::atomic<bool> symmetric = true;
+            parallel_for(A.cols(), num_threads(), MIN_SIZE_PER_THREAD, [&](const int begin, const int end) {
+                for (int j = begin; j < end && symmetric; ++j)
+                {
+                    for (int k = outer[j]; k < outer[j + 1]; ++k)
+                    {
+                        const int i = inner[k];
+                        const auto *mirror = std::lower_bound(inner + outer[i], inner + outer[i + 1], j);
+                        if (mirror == inner + outer[i + 1] || *mirror != j || values[mirror - inner] != values[k])
+                        {
+                            symmetric = false;
+                            break;
+                        }
+                    }
+                }
+            });
+
+            return symmetric;
         }
 
-        HYPRE_IJVectorAssemble(b);
-        HYPRE_IJVectorGetObject(b, (void **)&par_b);
+        // Rows of A (sizes, column indices and values) from its compressed columns. Each thread fills
+        // a range of rows, finding their entries in every column by bisection
+        void transpose_to_csr(const StiffnessMatrix &A, std::vector<HYPRE_Int> &row_sizes,
+                              std::vector<HYPRE_Int> &col_ids, std::vector<double> &values)
+        {
+            assert(A.isCompressed());
+            const int rows = A.rows();
+            const auto *outer = A.outerIndexPtr();
+            const auto *inner = A.innerIndexPtr();
+
+            // Calls func(j, first, last) with the entries [first, last) of column j in the rows [begin, end)
+            const auto for_each_column = [&](const int begin, const int end, const auto &func) {
+                for (int j = 0; j < A.cols(); ++j)
+                {
+                    const auto *first = std::lower_bound(inner + outer[j], inner + outer[j + 1], begin);
+                    const auto *last = std::lower_bound(first, inner + outer[j + 1], end);
+                    func(j, int(first - inner), int(last - inner));
+                }
+            };
+
+            row_sizes.assign(rows, 0);
+            parallel_for(rows, num_threads(), MIN_SIZE_PER_THREAD, [&](const int begin, const int end) {
+                for_each_column(begin, end, [&](const int j, const int first, const int last) {
+                    for (int k = first; k < last; ++k)
+                        ++row_sizes[inner[k]];
+                });
+            });
+
+            std::vector<int> row_start(rows + 1, 0);
+            for (int i = 0; i < rows; ++i)
+                row_start[i + 1] = row_start[i] + row_sizes[i];
+
+            col_ids.resize(A.nonZeros());
+            values.resize(A.nonZeros());
+            parallel_for(rows, num_threads(), MIN_SIZE_PER_THREAD, [&](const int begin, const int end) {
+                // Columns are visited in increasing order, so every row comes out sorted
+                std::vector<int> next(row_start.begin() + begin, row_start.begin() + end);
+                for_each_column(begin, end, [&](const int j, const int first, const int last) {
+                    for (int k = first; k < last; ++k)
+                    {
+                        const int pos = next[inner[k] - begin]++;
+                        col_ids[pos] = j;
+                        values[pos] = A.valuePtr()[k];
+                    }
+                });
+            });
+        }
 
-        HYPRE_IJVectorAssemble(x);
-        HYPRE_IJVectorGetObject(x, (void **)&par_x);
+        // ids as HYPRE_Int, copied into buffer only if the index types differ
+        template <typename Index>
+        const HYPRE_Int *as_hypre_indices(const Index *ids, const int size, std::vector<HYPRE_Int> &buffer)
+        {
+            if constexpr (std::is_same_v<Index, HYPRE_Int>)
+            {
+                return ids;
+            }
+            else
+            {
+                buffer.assign(ids, ids + size);
+                return buffer.data();
+            }
+        }
 
-        /* PCG with AMG preconditioner */
+    } // anonymous namespace
 
-        /* Create solver */
-        HYPRE_Solver solver, precond;
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void HypreSolver::factorize(const StiffnessMatrix &Ain)
+    {
+        assert(precond_num_ > 0);
+
+        const HYPRE_Int rows = Ain.rows();
+        const HYPRE_Int cols = Ain.cols();
+
+        // Keep the AMG hierarchy of a previous matrix if allowed, the outer PCG still uses the new matrix
+        const bool reuse_amg = has_solver_ && rows == rows_ && amg_reuse_count_ < amg_reuse_;
+
+        if (has_matrix_)
+        {
+            // The hierarchy references the matrix it was built from, keep it alive while reusing it
+            if (reuse_amg && !has_amg_matrix_)
+            {
+                amg_A_ = A;
+                has_amg_matrix_ = true;
+            }
+            else
+            {
+                HYPRE_IJMatrixDestroy(A);
+            }
+            has_matrix_ = false;
+        }
+
+        if (!reuse_amg && has_amg_matrix_)
+        {
+            HYPRE_IJMatrixDestroy(amg_A_);
+            has_amg_matrix_ = false;
+        }
+
+        has_matrix_ = true;
 #ifdef HYPRE_WITH_MPI
-        HYPRE_ParCSRPCGCreate(MPI_COMM_WORLD, &solver);
+        HYPRE_IJMatrixCreate(MPI_COMM_WORLD, 0, rows - 1, 0, cols - 1, &A);
 #else
-        HYPRE_ParCSRPCGCreate(0, &solver);
+        HYPRE_IJMatrixCreate(0, 0, rows - 1, 0, cols - 1, &A);
 #endif
+        // Hypre takes the matrix as CSR rows. The compressed columns of a symmetric matrix, as needed by
+        // PCG, are its rows and are handed over as is. Nonsymmetric input is transposed explicitly so
+        // that it is not solved with Aᵀ
+        StiffnessMatrix Acompressed;
+        if (!Ain.isCompressed())
+        {
+            Acompressed = Ain;
+            Acompressed.makeCompressed();
+        }
+        const StiffnessMatrix &Ac = Ain.isCompressed() ? Ain : Acompressed;
+
+        std::vector<HYPRE_Int> row_ids(rows);
+        std::vector<HYPRE_Int> n_cols(rows);
+        std::vector<HYPRE_Int> col_buffer;
+        std::vector<double> value_buffer;
+        const HYPRE_Int *col_ids;
+        const double *values;
+        if (is_symmetric(Ac))
+        {
+            const auto *outer = Ac.outerIndexPtr();
+            for (HYPRE_Int k = 0; k < rows; ++k)
+                n_cols[k] = outer[k + 1] - outer[k];
+            col_ids = as_hypre_indices(Ac.innerIndexPtr(), Ac.nonZeros(), col_buffer);
+            values = Ac.valuePtr();
+        }
+        else
+        {
+            transpose_to_csr(Ac, n_cols, col_buffer, value_buffer);
+            col_ids = col_buffer.data();
+            values = value_buffer.data();
+        }
+        for (HYPRE_Int k = 0; k < rows; ++k)
+            row_ids[k] = k;
 
-        /* Set some parameters (See Reference Manual for more parameters) */
-        HYPRE_PCGSetMaxIter(solver, max_iter_); /* max iterations */
-        HYPRE_PCGSetTol(solver, conv_tol_);     /* conv. tolerance */
-        HYPRE_PCGSetTwoNorm(solver, 1);         /* use the two norm as the stopping criteria */
-        // HYPRE_PCGSetPrintLevel(solver, 2); /* print solve info */
-        HYPRE_PCGSetLogging(solver, 1); /* needed to get run info later */
-
-        /* Now set up the AMG preconditioner and specify any parameters */
-        HYPRE_BoomerAMGCreate(&precond);
-
-#if 0
-    //HYPRE_BoomerAMGSetPrintLevel(precond, 2); /* print amg solution info */
-    HYPRE_BoomerAMGSetCoarsenType(precond, 6);
-    HYPRE_BoomerAMGSetOldDefault(precond);
-    HYPRE_BoomerAMGSetRelaxType(precond, 6); /* Sym G.S./Jacobi hybrid */
-    HYPRE_BoomerAMGSetNumSweeps(precond, 1);
-    HYPRE_BoomerAMGSetTol(precond, 0.0); /* conv. tolerance zero */
-    HYPRE_BoomerAMGSetMaxIter(precond, pre_max_iter_); /* do only one iteration! */
-#endif
+        // HYPRE_IJMatrixSetPrintLevel(A, 2);
+        HYPRE_IJMatrixSetObjectType(A, HYPRE_PARCSR);
+        HYPRE_IJMatrixSetRowSizes(A, n_cols.data());
+        HYPRE_IJMatrixInitialize(A);
+
+        HYPRE_IJMatrixSetValues(A, rows, n_cols.data(), row_ids.data(), col_ids, values);
+
+        HYPRE_IJMatrixAssemble(A);
+        HYPRE_IJMatrixGetObject(A, (void **)&parcsr_A);
+
+        if (rows != rows_)
+        {
+            if (has_vectors_)
+            {
+                HYPRE_IJVectorDestroy(b);
+                HYPRE_IJVectorDestroy(x);
+            }
+
+            HypreIJVector_Create(rows, b);
+            HypreIJVector_Create(rows, x);
+            has_vectors_ = true;
+            rows_ = rows;
+
+            indices_.resize(rows);
+            for (HYPRE_Int i = 0; i < rows; ++i)
+                indices_[i] = i;
 
-        HypreBoomerAMG_SetDefaultOptions(precond);
-        if (dimension_ > 1)
+            HYPRE_IJVectorAssemble(b);
+            HYPRE_IJVectorGetObject(b, (void **)&par_b);
+            HYPRE_IJVectorAssemble(x);
+            HYPRE_IJVectorGetObject(x, (void **)&par_x);
+        }
+
+        /* PCG with AMG preconditioner */
+        if (has_solver_)
         {
-            HypreBoomerAMG_SetElasticityOptions(precond, dimension_);
+            HYPRE_ParCSRPCGDestroy(solver);
+            if (!reuse_amg)
+            {
+                HYPRE_BoomerAMGDestroy(precond);
+                clear_interp_vectors();
+            }
         }
+        HyprePCG_Create(max_iter_, conv_tol_, solver);
 
-        /* Set the PCG preconditioner */
-        HYPRE_PCGSetPrecond(solver, (HYPRE_PtrToSolverFcn)HYPRE_BoomerAMGSolve, (HYPRE_PtrToSolverFcn)HYPRE_BoomerAMGSetup, precond);
+        if (reuse_amg)
+        {
+            ++amg_reuse_count_;
+            HYPRE_PCGSetPrecond(solver, (HYPRE_PtrToSolverFcn)HYPRE_BoomerAMGSolve, (HYPRE_PtrToSolverFcn)HypreBoomerAMG_SkipSetup, precond);
+        }
+        else
+        {
+            amg_reuse_count_ = 0;
+            HypreBoomerAMG_Create(dimension_, precond);
+            if (dimension_ > 1 && near_nullspace_.rows() == rows && near_nullspace_.cols() > 0)
+                set_interp_vectors();
+            HYPRE_PCGSetPrecond(solver, (HYPRE_PtrToSolverFcn)HYPRE_BoomerAMGSolve, (HYPRE_PtrToSolverFcn)HYPRE_BoomerAMGSetup, precond);
+        }
+        has_solver_ = true;
 
-        /* Now setup and solve! */
+        /* Setup once, the solver and preconditioner are kept until the next factorization */
         HYPRE_ParCSRPCGSetup(solver, parcsr_A, par_b, par_x);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void HypreSolver::set_near_nullspace(const Eigen::MatrixXd &B)
+    {
+        // BoomerAMG uses the near-nullspace as interpolation vectors of a nodal systems AMG, which
+        // needs the number of unknowns per vertex. It handles the translations itself, keep the rest.
+        const int dimension = split_translations(B, near_nullspace_);
+        if (dimension == 1)
+            throw std::runtime_error("[Hypre] near-nullspace must contain the translations of a 2D or 3D vector problem");
+        dimension_ = dimension;
+    }
+
+    void HypreSolver::set_vertex_coordinates(const Eigen::MatrixXd &V)
+    {
+        // The translations are already handled by the nodal systems AMG,
+        // the GM interpolation only needs the rotations
+        dimension_ = V.cols();
+        near_nullspace_ = rigid_body_modes(V, /*rotations_only=*/true);
+    }
+
+    void HypreSolver::set_interp_vectors()
+    {
+        assert(interp_vectors_.empty());
+        for (int k = 0; k < near_nullspace_.cols(); ++k)
+        {
+            HYPRE_IJVector v;
+            HYPRE_ParVector par_v;
+            HypreIJVector_Create(rows_, v);
+            HYPRE_IJVectorSetValues(v, rows_, indices_.data(), near_nullspace_.col(k).data());
+            HYPRE_IJVectorAssemble(v);
+            HYPRE_IJVectorGetObject(v, (void **)&par_v);
+
+            interp_vectors_.push_back(v);
+            par_interp_vectors_.push_back(par_v);
+        }
+
+        // Hypre keeps a pointer to the vectors, they are destroyed with the preconditioner
+        HYPRE_BoomerAMGSetInterpVectors(precond, par_interp_vectors_.size(), par_interp_vectors_.data());
+    }
+
+    void HypreSolver::clear_interp_vectors()
+    {
+        for (HYPRE_IJVector &v : interp_vectors_)
+            HYPRE_IJVectorDestroy(v);
+        interp_vectors_.clear();
+        par_interp_vectors_.clear();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void HypreSolver::set_tolerance(const double tol)
+    {
+        conv_tol_ = tol;
+        if (has_solver_)
+            HYPRE_PCGSetTol(solver, conv_tol_);
+    }
+
+    void HypreSolver::solve(const Eigen::Ref<const VectorXd> rhs, Eigen::Ref<VectorXd> result)
+    {
+        assert(has_solver_);
+        assert(rhs.size() == rows_);
+        assert(result.size() == rhs.size());
+
+        HYPRE_IJVectorSetValues(b, rows_, indices_.data(), rhs.data());
+        HYPRE_IJVectorSetValues(x, rows_, indices_.data(), result.data());
+
+        HYPRE_IJVectorAssemble(b);
+        HYPRE_IJVectorGetObject(b, (void **)&par_b);
+
+        HYPRE_IJVectorAssemble(x);
+        HYPRE_IJVectorGetObject(x, (void **)&par_x);
+
         HYPRE_ParCSRPCGSolve(solver, parcsr_A, par_b, par_x);
 
         /* Run info - needed logging turned on */
@@ -275,28 +513,50 @@ namespace polysolve::linear
         // printf("Final Relative Residual Norm = %g\n", final_res_norm);
         // printf("\n");
 
-        /* Destroy solver and preconditioner */
-        HYPRE_BoomerAMGDestroy(precond);
-        HYPRE_ParCSRPCGDestroy(solver);
+        HYPRE_IJVectorGetValues(x, rows_, indices_.data(), result.data());
+    }
 
-        assert(result.size() == rhs.size());
-        for (HYPRE_Int i = 0; i < rhs.size(); ++i)
-        {
-            const HYPRE_Int index[1] = {i};
-            HYPRE_Complex v[1];
-            HYPRE_IJVectorGetValues(x, 1, index, v);
+    void HypreSolver::solve(const Eigen::Ref<const Eigen::MatrixXd> rhs, Eigen::MatrixXd &result)
+    {
+        if (result.rows() != rhs.rows() || result.cols() != rhs.cols())
+            result.setZero(rhs.rows(), rhs.cols());
 
-            result(i) = v[0];
+        HYPRE_Int max_num_iterations = 0;
+        HYPRE_Complex max_final_res_norm = 0;
+        for (Eigen::Index j = 0; j < rhs.cols(); ++j)
+        {
+            solve(rhs.col(j), result.col(j));
+            max_num_iterations = std::max(max_num_iterations, num_iterations);
+            max_final_res_norm = std::max(max_final_res_norm, final_res_norm);
         }
 
-        HYPRE_IJVectorDestroy(b);
-        HYPRE_IJVectorDestroy(x);
+        // Report the worst column
+        num_iterations = max_num_iterations;
+        final_res_norm = max_final_res_norm;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
 
     HypreSolver::~HypreSolver()
     {
+        if (has_solver_)
+        {
+            HYPRE_BoomerAMGDestroy(precond);
+            HYPRE_ParCSRPCGDestroy(solver);
+            clear_interp_vectors();
+            has_solver_ = false;
+        }
+        if (has_vectors_)
+        {
+            HYPRE_IJVectorDestroy(b);
+            HYPRE_IJVectorDestroy(x);
+            has_vectors_ = false;
+        }
+        if (has_amg_matrix_)
+        {
+            HYPRE_IJMatrixDestroy(amg_A_);
+            has_amg_matrix_ = false;
+        }
         if (has_matrix_)
         {
             HYPRE_IJMatrixDestroy(A);
@@ -47,9 +47,22 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &A) override;
 
+        // Set the vectors used by the GM interpolation of elasticity problems. B must contain the
+        // translations, from which the elasticity dimension is found; throws otherwise.
+        virtual void set_near_nullspace(const Eigen::MatrixXd &B) override;
+
+        // Set the elasticity dimension and the rotations of the vertices as interpolation vectors
+        virtual void set_vertex_coordinates(const Eigen::MatrixXd &V) override;
+
+        // Set the relative residual tolerance of the next solves
+        virtual void set_tolerance(const double tol) override;
+
         // Solve the linear system Ax = b
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
 
+        // Solve the linear system AX = B
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
+
         // Name of the solver type (for debugging purposes)
         virtual std::string name() const override { return "Hypre"; }
 
@@ -58,6 +71,7 @@ namespace polysolve::linear
         int max_iter_ = 1000;
         int pre_max_iter_ = 1;
         double conv_tol_ = 1e-10;
+        int amg_reuse_ = 0; // number of subsequent factorizations that keep the AMG hierarchy
 
         HYPRE_Int num_iterations;
         HYPRE_Complex final_res_norm;
@@ -68,6 +82,32 @@ namespace polysolve::linear
 
         HYPRE_IJMatrix A;
         HYPRE_ParCSRMatrix parcsr_A;
+
+        // PCG and BoomerAMG are set up in factorize and kept until the next one
+        bool has_solver_ = false;
+        HYPRE_Solver solver;
+        HYPRE_Solver precond;
+
+        // Matrix the AMG hierarchy was built from, when it is reused
+        bool has_amg_matrix_ = false;
+        HYPRE_IJMatrix amg_A_;
+        int amg_reuse_count_ = 0;
+
+        bool has_vectors_ = false;
+        HYPRE_Int rows_ = 0;
+        HYPRE_IJVector b;
+        HYPRE_ParVector par_b;
+        HYPRE_IJVector x;
+        HYPRE_ParVector par_x;
+        std::vector<HYPRE_Int> indices_; // 0, ..., rows_ - 1 for bulk vector transfers
+
+        // Near-nullspace used as interpolation vectors, kept alive as long as the preconditioner
+        Eigen::MatrixXd near_nullspace_;
+        std::vector<HYPRE_IJVector> interp_vectors_;
+        std::vector<HYPRE_ParVector> par_interp_vectors_;
+
+        void set_interp_vectors();
+        void clear_interp_vectors();
     };
 
 } // namespace polysolve::linear
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <polysolve/Types.hpp>
+
+namespace polysolve::linear
+{
+    /**
+     * @brief      Square linear operator y = A x, for solvers that never need the assembled matrix.
+     */
+    class LinearOperator
+    {
+    public:
+        virtual ~LinearOperator() = default;
+
+        // Number of rows (and columns) of the operator
+        virtual int rows() const = 0;
+
+        // Compute y = A x
+        virtual void apply(const Eigen::Ref<const Eigen::VectorXd> x, Eigen::Ref<Eigen::VectorXd> y) const = 0;
+
+        // Diagonal of A, used by Jacobi preconditioners. Returns false if not available.
+        virtual bool diagonal(Eigen::VectorXd &d) const { return false; }
+
+        // Size of the diagonal blocks returned by block_diagonal (e.g., the dimension of vector problems)
+        virtual int block_size() const { return 1; }
+
+        // Diagonal blocks of A stacked vertically (rows() x block_size()), used by block-Jacobi
+        // preconditioners. Returns false if not available.
+        virtual bool block_diagonal(Eigen::MatrixXd &blocks) const { return false; }
+    };
+
+    /**
+     * @brief      Linear operator of an assembled sparse matrix, which must outlive it.
+     */
+    class SparseMatrixOperator : public LinearOperator
+    {
+    public:
+        SparseMatrixOperator(const StiffnessMatrix &A, const int block_size = 1)
+            : A_(A), block_size_(block_size)
+        {
+            assert(A.rows() == A.cols());
+            assert(block_size > 0 && A.rows() % block_size == 0);
+        }
+
+        int rows() const override { return A_.rows(); }
+
+        void apply(const Eigen::Ref<const Eigen::VectorXd> x, Eigen::Ref<Eigen::VectorXd> y) const override
+        {
+            y.noalias() = A_ * x;
+        }
+
+        bool diagonal(Eigen::VectorXd &d) const override
+        {
+            d = A_.diagonal();
+            return true;
+        }
+
+        int block_size() const override { return block_size_; }
+
+        bool block_diagonal(Eigen::MatrixXd &blocks) const override
+        {
+            blocks.setZero(A_.rows(), block_size_);
+            for (int k = 0; k < A_.outerSize(); ++k)
+            {
+                for (StiffnessMatrix::InnerIterator it(A_, k); it; ++it)
+                {
+                    if (it.row() / block_size_ == it.col() / block_size_)
+                        blocks(it.row(), it.col() % block_size_) = it.value();
+                }
+            }
+            return true;
+        }
+
+    private:
+        const StiffnessMatrix &A_;
+        const int block_size_;
+    };
+
+} // namespace polysolve::linear
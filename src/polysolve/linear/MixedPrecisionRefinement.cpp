@@ -0,0 +1,180 @@
+#include "MixedPrecisionRefinement.hpp"
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace polysolve::linear
+{
+    typedef Eigen::SparseMatrix<float, Eigen::ColMajor, StiffnessMatrix::StorageIndex> StiffnessMatrixF;
+
+    class MixedPrecisionRefinement::InnerSolver
+    {
+    public:
+        virtual ~InnerSolver() = default;
+
+        virtual void analyze_pattern(const StiffnessMatrixF &A) = 0;
+        virtual void factorize(const StiffnessMatrixF &A) = 0;
+        virtual Eigen::VectorXf solve(const Eigen::VectorXf &b) const = 0;
+    };
+
+    namespace
+    {
+        template <typename SparseSolver>
+        class EigenInnerSolver : public MixedPrecisionRefinement::InnerSolver
+        {
+        public:
+            void analyze_pattern(const StiffnessMatrixF &A) override { m_Solver.analyzePattern(A); }
+
+            void factorize(const StiffnessMatrixF &A) override
+            {
+                m_Solver.factorize(A);
+                if (m_Solver.info() != Eigen::Success)
+                {
+                    throw std::runtime_error("[MixedPrecisionRefinement] NumericalIssue encountered.");
+                }
+            }
+
+            Eigen::VectorXf solve(const Eigen::VectorXf &b) const override { return m_Solver.solve(b); }
+
+        private:
+            SparseSolver m_Solver;
+        };
+
+        std::unique_ptr<MixedPrecisionRefinement::InnerSolver> create_inner_solver(const std::string &name)
+        {
+            if (name == "Eigen::SimplicialLDLT")
+            {
+                return std::make_unique<EigenInnerSolver<Eigen::SimplicialLDLT<StiffnessMatrixF>>>();
+            }
+            else if (name == "Eigen::SimplicialLLT")
+            {
+                return std::make_unique<EigenInnerSolver<Eigen::SimplicialLLT<StiffnessMatrixF>>>();
+            }
+            else if (name == "Eigen::SparseLU")
+            {
+                return std::make_unique<EigenInnerSolver<Eigen::SparseLU<StiffnessMatrixF>>>();
+            }
+            throw std::runtime_error("[MixedPrecisionRefinement] Unrecognized inner solver type: " + name);
+        }
+    } // namespace
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    MixedPrecisionRefinement::MixedPrecisionRefinement()
+    {
+        max_iter_ = 10;
+        conv_tol_ = 1e-10;
+        inner_solver_name_ = "Eigen::SimplicialLDLT";
+        inner_solver_ = create_inner_solver(inner_solver_name_);
+
+        final_res_norm_ = 0;
+        num_iterations_ = 0;
+    }
+
+    MixedPrecisionRefinement::~MixedPrecisionRefinement() = default;
+
+    // Set solver parameters
+    void MixedPrecisionRefinement::set_parameters(const json &params)
+    {
+        if (params.contains("MixedPrecisionRefinement"))
+        {
+            if (params["MixedPrecisionRefinement"].contains("max_iter"))
+            {
+                max_iter_ = params["MixedPrecisionRefinement"]["max_iter"];
+            }
+            if (params["MixedPrecisionRefinement"].contains("tolerance"))
+            {
+                conv_tol_ = params["MixedPrecisionRefinement"]["tolerance"];
+            }
+            if (params["MixedPrecisionRefinement"].contains("inner_solver"))
+            {
+                const std::string name = params["MixedPrecisionRefinement"]["inner_solver"];
+                if (name != inner_solver_name_)
+                {
+                    inner_solver_ = create_inner_solver(name);
+                    inner_solver_name_ = name;
+                }
+            }
+        }
+    }
+
+    void MixedPrecisionRefinement::get_info(json &params) const
+    {
+        params["num_iterations"] = num_iterations_;
+        params["final_res_norm"] = final_res_norm_;
+        params["inner_solver"] = inner_solver_name_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void MixedPrecisionRefinement::analyze_pattern(const StiffnessMatrix &A, const int precond_num)
+    {
+        inner_solver_->analyze_pattern(A.cast<float>());
+    }
+
+    void MixedPrecisionRefinement::factorize(const StiffnessMatrix &A)
+    {
+        const StiffnessMatrixF Af = A.cast<float>();
+        if (!Eigen::Map<const Eigen::VectorXf>(Af.valuePtr(), Af.nonZeros()).allFinite())
+        {
+            throw std::runtime_error("[MixedPrecisionRefinement] Matrix coefficients overflow in single precision.");
+        }
+
+        inner_solver_->factorize(Af);
+        // The caller may release A after factorize, so keep a copy for the residuals
+        A_ = A;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void MixedPrecisionRefinement::solve(const Ref<const VectorXd> b, Ref<VectorXd> x)
+    {
+        assert(A_.rows() == b.size());
+
+        x.setZero();
+        num_iterations_ = 0;
+        final_res_norm_ = 0;
+
+        const double b_norm = b.norm();
+        if (b_norm == 0)
+        {
+            return;
+        }
+
+        VectorXd r = b;
+        double r_norm = b_norm;
+        while (num_iterations_ < max_iter_)
+        {
+            // Normalize the residual so that it stays in the single precision range
+            const VectorXd d = inner_solver_->solve((r / r_norm).cast<float>()).cast<double>() * r_norm;
+            x += d;
+            ++num_iterations_;
+
+            r = b - A_ * x;
+            const double new_r_norm = r.norm();
+            if (!(new_r_norm < r_norm))
+            {
+                // The matrix is too ill-conditioned for the single precision factorization
+                throw std::runtime_error(fmt::format(
+                    "[MixedPrecisionRefinement] Refinement stalled after {} iterations, relative residual {:g} above the tolerance {:g}.",
+                    num_iterations_, r_norm / b_norm, conv_tol_));
+            }
+
+            r_norm = new_r_norm;
+            if (r_norm <= conv_tol_ * b_norm)
+            {
+                break;
+            }
+        }
+
+        // Reaching max_iter is not an error, the residual is reported by get_info
+        final_res_norm_ = r_norm / b_norm;
+    }
+
+} // namespace polysolve::linear
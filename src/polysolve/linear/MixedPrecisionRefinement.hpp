@@ -0,0 +1,69 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+#include "Solver.hpp"
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <memory>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Factorizes a single precision copy of the matrix and recovers double precision
+// accuracy with iterative refinement: x += A_f⁻¹ (b - A x), with the residual in double.
+//
+
+namespace polysolve::linear
+{
+
+    class MixedPrecisionRefinement : public Solver
+    {
+
+    public:
+        MixedPrecisionRefinement();
+        ~MixedPrecisionRefinement();
+
+    private:
+        POLYSOLVE_DELETE_MOVE_COPY(MixedPrecisionRefinement)
+
+    public:
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        // Set solver parameters
+        virtual void set_parameters(const json &params) override;
+
+        // Retrieve information on the last solve
+        virtual void get_info(json &params) const override;
+
+        // Analyze sparsity pattern
+        virtual void analyze_pattern(const StiffnessMatrix &A, const int precond_num) override;
+
+        // Factorize system matrix
+        virtual void factorize(const StiffnessMatrix &A) override;
+
+        // Solve the linear system Ax = b
+        virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
+
+        // Name of the solver type (for debugging purposes)
+        virtual std::string name() const override { return "MixedPrecisionRefinement"; }
+
+        // Single precision factorization
+        class InnerSolver;
+
+    private:
+        int max_iter_;
+        double conv_tol_;
+        std::string inner_solver_name_;
+
+        std::unique_ptr<InnerSolver> inner_solver_;
+
+        // Double precision matrix for the residuals
+        StiffnessMatrix A_;
+
+        double final_res_norm_;
+        int num_iterations_;
+    };
+
+} // namespace polysolve::linear
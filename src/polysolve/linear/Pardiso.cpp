@@ -2,6 +2,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 #include "Pardiso.hpp"
+#include <polysolve/Utils.hpp>
+#include <algorithm>
 #include <thread>
 #ifdef POLYSOLVE_WITH_MKL
 #include <mkl_pardiso.h>
@@ -77,6 +79,8 @@ namespace polysolve::linear
 
         error = 0;
         solver = 0; // Use sparse direct solver
+        hasPattern = false;
+        needsSymbolicFactorization = true;
 #ifdef POLYSOLVE_WITH_MKL
         pardisoinit(pt, &mtype, iparm);
 #else
@@ -141,59 +145,81 @@ namespace polysolve::linear
 
     namespace
     {
+        // Minimum number of rows per thread, below this the conversion runs serially
+        constexpr int MIN_ROWS_PER_THREAD = 4096;
 
-        // Count number of non-zeros
-        int countNonZeros(const StiffnessMatrix &K, bool upperOnly)
+        // First entry of row r with c >= r (inner indices are sorted in compressed mode)
+        int upperBegin(const StiffnessMatrix &K, int r)
         {
-            int count = 0;
-            for (int r = 0; r < K.rows(); ++r)
+            const auto *begin = K.innerIndexPtr() + K.outerIndexPtr()[r];
+            const auto *end = K.innerIndexPtr() + K.outerIndexPtr()[r + 1];
+            return int(std::lower_bound(begin, end, r) - K.innerIndexPtr());
+        }
+
+        // Compute 1-based indices of matrix coeffs in CRS format, and the position in
+        // K.valuePtr() of each coefficient in the upper triangular case
+        void computeIndices(const StiffnessMatrix &K, Eigen::VectorXi &ia, Eigen::VectorXi &ja,
+                            std::vector<int> &coeffIndex, bool upperOnly, int num_threads)
+        {
+            const int rows = int(K.rows());
+            ia.resize(rows + 1);
+
+            if (!upperOnly)
             {
-                for (int j = K.outerIndexPtr()[r]; j < K.outerIndexPtr()[r + 1]; ++j)
+                typedef Eigen::Matrix<StiffnessMatrix::StorageIndex, Eigen::Dynamic, 1> IndexVector;
+                ia = Eigen::Map<const IndexVector>(K.outerIndexPtr(), rows + 1).cast<int>().array() + 1;
+                ja = Eigen::Map<const IndexVector>(K.innerIndexPtr(), K.nonZeros()).cast<int>().array() + 1;
+                coeffIndex.clear();
+                return;
+            }
+
+            // Count non-zeros of each row, then prefix sum
+            std::vector<int> first(rows);
+            parallel_for(rows, num_threads, MIN_ROWS_PER_THREAD, [&](int begin, int end) {
+                for (int r = begin; r < end; ++r)
                 {
-                    int c = K.innerIndexPtr()[j];
-                    if (!upperOnly || r <= c)
-                    {
-                        ++count;
-                    }
+                    first[r] = upperBegin(K, r);
+                    ia(r + 1) = K.outerIndexPtr()[r + 1] - first[r];
                 }
+            });
+            ia(0) = 1;
+            for (int r = 0; r < rows; ++r)
+            {
+                ia(r + 1) += ia(r);
             }
-            return count;
-        }
 
-        // Compute indices of matrix coeffs in CRS format
-        void computeIndices(const StiffnessMatrix &K, Eigen::VectorXi &ia, Eigen::VectorXi &ja, bool upperOnly)
-        {
-            int count = 0;
-            for (int r = 0; r < K.rows(); ++r)
-            {
-                ia(r) = count;
-                for (int j = K.outerIndexPtr()[r]; j < K.outerIndexPtr()[r + 1]; ++j)
+            const int nnz = ia(rows) - 1;
+            ja.resize(nnz);
+            coeffIndex.resize(nnz);
+            parallel_for(rows, num_threads, MIN_ROWS_PER_THREAD, [&](int begin, int end) {
+                for (int r = begin; r < end; ++r)
                 {
-                    int c = K.innerIndexPtr()[j];
-                    if (!upperOnly || r <= c)
+                    int count = ia(r) - 1;
+                    for (int j = first[r]; j < K.outerIndexPtr()[r + 1]; ++j, ++count)
                     {
-                        ja(count++) = c;
+                        ja(count) = K.innerIndexPtr()[j] + 1;
+                        coeffIndex[count] = j;
                     }
                 }
-            }
-            ia.tail<1>()[0] = count;
+            });
         }
 
         // Compute non-zero coefficients and put them in 'a'
-        void computeCoeffs(const StiffnessMatrix &K, Eigen::VectorXd &a, bool upperOnly)
+        void computeCoeffs(const StiffnessMatrix &K, Eigen::VectorXd &a, const std::vector<int> &coeffIndex, bool upperOnly, int num_threads)
         {
-            int count = 0;
-            for (int r = 0; r < K.rows(); ++r)
+            if (!upperOnly)
             {
-                for (int j = K.outerIndexPtr()[r]; j < K.outerIndexPtr()[r + 1]; ++j)
+                a = Eigen::Map<const Eigen::VectorXd>(K.valuePtr(), K.nonZeros());
+                return;
+            }
+
+            a.resize(coeffIndex.size());
+            parallel_for(int(coeffIndex.size()), num_threads, MIN_ROWS_PER_THREAD, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i)
                 {
-                    int c = K.innerIndexPtr()[j];
-                    if (!upperOnly || r <= c)
-                    {
-                        a(count++) = K.valuePtr()[j];
-                    }
+                    a(i) = K.valuePtr()[coeffIndex[i]];
                 }
-            }
+            });
         }
 
     } // anonymous namespace
@@ -208,18 +234,28 @@ namespace polysolve::linear
         }
         assert(A.isCompressed());
 
+        // Same pattern as the last analysis: the indices and the reordering can be reused
+        const size_t hash = sparsity_pattern_hash(A);
+        if (hasPattern && numRows == A.rows() && hash == patternHash)
+        {
+            return;
+        }
+
         numRows = (int)A.rows();
-        int nnz = countNonZeros(A, isSymmetric());
-        ia.resize(numRows + 1);
-        ja.resize(nnz);
-        a.resize(nnz);
-        computeIndices(A, ia, ja, isSymmetric());
-        computeCoeffs(A, a, isSymmetric());
+        computeIndices(A, ia, ja, coeffIndex, isSymmetric(), iparm[2]);
 
-        // Convert matrix from 0-based C-notation to Fortran 1-based notation.
-        ia = ia.array() + 1;
-        ja = ja.array() + 1;
+        hasPattern = true;
+        patternHash = hash;
 
+        // The reordering needs the coefficients (e.g., for weighted matching), so it is
+        // deferred to the first factorization
+        needsSymbolicFactorization = true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void Pardiso::symbolicFactorization()
+    {
 #ifdef PLOTS_PARDISO
         // --------------------------------------------------------------------
         //  .. pardiso_chk_matrix(...)
@@ -248,6 +284,8 @@ namespace polysolve::linear
 #endif
         if (error != 0)
         {
+            // Analyze again on the next call instead of reusing a failed reordering
+            hasPattern = false;
             throw std::runtime_error("[Pardiso] ERROR during symbolic factorization: " + std::to_string(error));
         }
 
@@ -266,10 +304,16 @@ namespace polysolve::linear
         {
             throw std::runtime_error("[Pardiso] mtype not set.");
         }
-        assert(ia.size() == A.rows() + 1);
+        assert(hasPattern && ia.size() == A.rows() + 1);
 
         // Update cached coefficients
-        computeCoeffs(A, a, isSymmetric());
+        computeCoeffs(A, a, coeffIndex, isSymmetric(), iparm[2]);
+
+        if (needsSymbolicFactorization)
+        {
+            symbolicFactorization();
+            needsSymbolicFactorization = false;
+        }
 
         // --------------------------------------------------------------------
         // ..  Numerical factorization.
@@ -334,6 +378,44 @@ namespace polysolve::linear
 
 #endif
         result.resize(numRows, 1);
+        backSubstitution(rhs_ptr, result.data(), 1);
+
+#ifdef PLOTS_PARDISO
+        printf("\nSolve completed ... ");
+        printf("\nThe solution of the system is: ");
+        for (int i = 0; i < numRows; i++)
+        {
+            printf("\n x [%d] = % f", i, result.data()[i]);
+        }
+        printf("\n\n");
+#endif
+    }
+
+    void Pardiso::solve(const Eigen::Ref<const Eigen::MatrixXd> rhs, Eigen::MatrixXd &result)
+    {
+        if (mtype == -1)
+        {
+            throw std::runtime_error("[Pardiso] mtype not set.");
+        }
+        assert(numRows == rhs.rows());
+
+        // Pardiso expects the right-hand sides stored contiguously (leading dimension = numRows)
+        Eigen::MatrixXd rhs_copy;
+        double *rhs_ptr = const_cast<double *>(rhs.data());
+        if (rhs.outerStride() != rhs.rows())
+        {
+            rhs_copy = rhs;
+            rhs_ptr = rhs_copy.data();
+        }
+
+        result.resize(numRows, rhs.cols());
+        backSubstitution(rhs_ptr, result.data(), int(rhs.cols()));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void Pardiso::backSubstitution(double *rhs_ptr, double *result_ptr, int num_rhs)
+    {
         // --------------------------------------------------------------------
         // ..  Back substitution and iterative refinement.
         // --------------------------------------------------------------------
@@ -343,25 +425,16 @@ namespace polysolve::linear
 
 #ifdef POLYSOLVE_WITH_MKL
         pardiso(pt, &maxfct, &mnum, &mtype, &phase, &numRows, a.data(), ia.data(), ja.data(),
-                &idum, &nrhs, iparm, &msglvl, rhs_ptr, result.data(), &error);
+                &idum, &num_rhs, iparm, &msglvl, rhs_ptr, result_ptr, &error);
 #else
         pardiso(pt, &maxfct, &mnum, &mtype, &phase, &numRows, a.data(), ia.data(), ja.data(),
-                &idum, &nrhs, iparm, &msglvl, rhs_ptr, result.data(), &error, dparm);
+                &idum, &num_rhs, iparm, &msglvl, rhs_ptr, result_ptr, &error, dparm);
 #endif
 
         if (error != 0)
         {
             throw std::runtime_error("[Pardiso] ERROR during solution: " + std::to_string(error));
         }
-#ifdef PLOTS_PARDISO
-        printf("\nSolve completed ... ");
-        printf("\nThe solution of the system is: ");
-        for (int i = 0; i < numRows; i++)
-        {
-            printf("\n x [%d] = % f", i, result.data()[i]);
-        }
-        printf("\n\n");
-#endif
 
         // --------------------------------------------------------------------
         // ..  Back substitution with transposed matrix A^t x=b
@@ -375,25 +448,15 @@ namespace polysolve::linear
 
 #ifdef POLYSOLVE_WITH_MKL
             pardiso(pt, &maxfct, &mnum, &mtype, &phase, &numRows, a.data(), ia.data(),
-                    ja.data(), &idum, &nrhs, iparm, &msglvl, rhs_ptr, result.data(), &error);
+                    ja.data(), &idum, &num_rhs, iparm, &msglvl, rhs_ptr, result_ptr, &error);
 #else
             pardiso(pt, &maxfct, &mnum, &mtype, &phase, &numRows, a.data(), ia.data(),
-                    ja.data(), &idum, &nrhs, iparm, &msglvl, rhs_ptr, result.data(), &error, dparm);
+                    ja.data(), &idum, &num_rhs, iparm, &msglvl, rhs_ptr, result_ptr, &error, dparm);
 #endif
             if (error != 0)
             {
                 throw std::runtime_error("[Pardiso] ERROR during solution: " + std::to_string(error));
             }
-
-#ifdef PLOTS_PARDISO
-            printf("\nSolve completed ... ");
-            printf("\nThe solution of the system is: ");
-            for (int i = 0; i < numRows; i++)
-            {
-                printf("\n x [%d] = % f", i, result.data()[i]);
-            }
-            printf("\n");
-#endif
         }
     }
 
@@ -32,6 +32,12 @@ namespace polysolve::linear
         void init();
         void freeNumericalFactorizationMemory();
 
+        // Reordering and symbolic factorization (phase 11) of the current ia/ja/a
+        void symbolicFactorization();
+
+        // Back substitution (phase 33) for num_rhs column-major right-hand sides
+        void backSubstitution(double *rhs_ptr, double *result_ptr, int num_rhs);
+
     public:
         //////////////////////
         // Public interface //
@@ -52,6 +58,9 @@ namespace polysolve::linear
         // Solve the linear system Ax = b
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) override;
 
+        // Solve the linear system AX = B with all right-hand sides at once
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X) override;
+
         // Name of the solver type (for debugging purposes)
         virtual std::string name() const override { return "Pardiso"; }
 
@@ -59,9 +68,17 @@ namespace polysolve::linear
         Eigen::VectorXi ia, ja;
         VectorXd a;
 
+        // Position in A.valuePtr() of each coefficient of 'a' (unused if 'a' is a copy of A.valuePtr())
+        std::vector<int> coeffIndex;
+
     protected:
         int numRows;
 
+        // Sparsity pattern of ia/ja, the reordering is only recomputed when it changes
+        bool hasPattern = false;
+        size_t patternHash;
+        bool needsSymbolicFactorization = true;
+
         ///////////////////
         // Pardiso stuff //
         ///////////////////
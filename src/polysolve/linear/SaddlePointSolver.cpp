@@ -1,5 +1,6 @@
 #include "SaddlePointSolver.hpp"
 
+#include <spdlog/spdlog.h>
 #include <unsupported/Eigen/SparseExtra>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -21,31 +22,29 @@ namespace polysolve::linear
             X = StiffnessMatrix(dyn_X);
         }
 
-        void compute_solution(const int i, const Eigen::VectorXd &alphau, const Eigen::VectorXd &alphap,
-                              const std::vector<Eigen::VectorXd> &yu, const std::vector<Eigen::VectorXd> &yp,
-                              const StiffnessMatrix &Wm, const StiffnessMatrix &Wc,
-                              Eigen::Ref<Eigen::VectorXd> result)
+        // Grow the number of columns geometrically, keeping the existing ones
+        void reserve_cols(const int cols, Eigen::MatrixXd &M)
         {
-            // yu = alphau(1) * iters{1}.yu;
-            // yp = alphap(1) * iters{1}.yp;
-            Eigen::VectorXd yuf = alphau(0) * yu[0];
-            Eigen::VectorXd ypf = alphap(0) * yp[0];
+            if (M.cols() < cols)
+                M.conservativeResize(Eigen::NoChange, std::max<Eigen::Index>(cols, 2 * M.cols()));
+        }
 
-            for (int j = 1; j < i; ++j)
+        void reserve_square(const int size, Eigen::MatrixXd &M)
+        {
+            if (M.cols() < size)
             {
-                // yu = yu + alphau(j) * iters{j}.yu;
-                // yp = yp + alphap(j) * iters{j}.yp;
-
-                yuf += alphau(j) * yu[j];
-                ypf += alphap(j) * yp[j];
+                const Eigen::Index new_size = std::max<Eigen::Index>(size, 2 * M.cols());
+                M.conservativeResize(new_size, new_size);
             }
+        }
 
-            yuf = Wm * yuf;
-            ypf = Wc * ypf;
-
-            result.resize(yuf.size() + ypf.size());
-            result.topRows(yuf.size()) = yuf;
-            result.bottomRows(ypf.size()) = ypf;
+        // Create an inner solver through the validated json path, params are old-style linear solver
+        // settings (e.g., {"Eigen::GMRES": {...}}) and are checked against the spec
+        std::unique_ptr<Solver> create_inner_solver(const std::string &name, const json &params)
+        {
+            json solver_params = params.is_object() ? params : json::object();
+            solver_params["solver"] = name;
+            return Solver::create(solver_params, *spdlog::default_logger());
         }
     } // namespace
 
@@ -100,6 +99,10 @@ namespace polysolve::linear
         {
             symmetric_solver_params_ = params["symmetric_solver_params"];
         }
+
+        // Recreated with the new settings at the next factorization
+        asymmetric_solver_.reset();
+        symmetric_solver_.reset();
     }
 
     void SaddlePointSolver::get_info(json &params) const
@@ -113,7 +116,6 @@ namespace polysolve::linear
     void SaddlePointSolver::factorize(const StiffnessMatrix &Ain)
     {
         assert(precond_num_ > 0);
-        Ain_ = Ain;
         // A = M.A(1:ablock-1, 1:ablock-1);
         // B = M.A(1:ablock-1, ablock:end);
         // Bt = M.A(ablock:end, 1:ablock-1);
@@ -125,6 +127,10 @@ namespace polysolve::linear
         const StiffnessMatrix B = Ain.block(0, precond_num_, precond_num_, other_size);
         const StiffnessMatrix C = Ain.block(precond_num_, precond_num_, other_size, other_size);
 
+        // The system must be symmetric: the lower-left block is never read, the residuals of solve use Bᵀ instead
+        assert((StiffnessMatrix(Ain.block(precond_num_, 0, other_size, precond_num_)) - StiffnessMatrix(B.transpose())).norm()
+               <= 1e-12 * (1 + B.norm()));
+
         // Wm = spdiags(sqrt(1./diag(A)), 0, length(A), length(A));
         // Wc = spdiags(sqrt(1./diag(C)), 0, length(C), length(C));
         Eigen::VectorXd Wmd = A.diagonal();
@@ -137,12 +143,28 @@ namespace polysolve::linear
         Wc.resize(C.rows(), C.cols());
         Wc.setIdentity();
 
+        // Inverse scalings, to recover the residual of the input system from the scaled one
+        Wm_inv = 1. / Wmd.array();
+        Wc_inv = Eigen::VectorXd::Ones(C.rows());
+
         As = Wm * A * Wm;
         Bs = Wm * B * Wc;
         BsT = Bs.transpose();
         Cs = Wc * C * Wc;
 
         Ss = Cs - BsT * Bs;
+
+        // As and Ss are fixed until the next factorization, factorize them once for all iterations and solves
+        if (!asymmetric_solver_)
+            asymmetric_solver_ = create_inner_solver(asymmetric_solver_name_, asymmetric_solver_params_);
+        if (!symmetric_solver_)
+            symmetric_solver_ = create_inner_solver(symmetric_solver_name_, symmetric_solver_params_);
+
+        asymmetric_solver_->analyze_pattern(As, As.rows());
+        asymmetric_solver_->factorize(As);
+
+        symmetric_solver_->analyze_pattern(Ss, Ss.rows());
+        symmetric_solver_->factorize(Ss);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -150,140 +172,134 @@ namespace polysolve::linear
     void SaddlePointSolver::solve(const Eigen::Ref<const VectorXd> rhs, Eigen::Ref<VectorXd> result)
     {
         assert(rhs.cols() == 1);
-        const Eigen::VectorXd Rm = rhs.block(0, 0, precond_num_, 1);
-        const Eigen::VectorXd Rc = rhs.block(precond_num_, 0, rhs.size() - precond_num_, 1);
+        assert(asymmetric_solver_ && symmetric_solver_);
+
+        const int m_size = precond_num_;
+        const int c_size = rhs.size() - precond_num_;
 
-        const Eigen::VectorXd Rms = Wm * Rm;
-        const Eigen::VectorXd Rcs = Wc * Rc;
+        const Eigen::VectorXd Rms = Wm * rhs.head(m_size);
+        const Eigen::VectorXd Rcs = Wc * rhs.tail(c_size);
 
         Eigen::VectorXd currentRms = Rms;
         Eigen::VectorXd currentRcs = Rcs;
 
         Eigen::VectorXd Rcst, Rmst;
 
-        std::vector<Eigen::VectorXd> yu, yp, Rmu, Rmp, Rcu, Rcp;
-        Eigen::VectorXd alphau;
-        Eigen::VectorXd alphap;
+        // One column per iteration, in contiguous storage
+        Eigen::MatrixXd yu(m_size, 0), yp(c_size, 0);
+        Eigen::MatrixXd Rmu(m_size, 0), Rmp(m_size, 0), Rcu(c_size, 0), Rcp(c_size, 0);
 
-        auto asymmetric_solver = Solver::create(asymmetric_solver_name_, "");
-        auto symmetric_solver = Solver::create(symmetric_solver_name_, "");
-        asymmetric_solver->set_parameters(asymmetric_solver_params_);
-        symmetric_solver->set_parameters(symmetric_solver_params_);
+        // Gram matrices of the iterates, Apu = Aup^T
+        Eigen::MatrixXd Auu, Aup, App;
+        Eigen::VectorXd bu, bp;
 
-        symmetric_solver->analyze_pattern(Ss, Ss.rows());
-        symmetric_solver->factorize(Ss);
+        Eigen::VectorXd alphau;
+        Eigen::VectorXd alphap;
 
         int i;
         for (i = 0; i < max_iter_; ++i)
         {
-            yu.emplace_back(Rm.size());
-            yp.emplace_back(Rc.size());
+            const int n = i + 1;
+
+            for (Eigen::MatrixXd *M : {&yu, &yp, &Rmu, &Rmp, &Rcu, &Rcp})
+                reserve_cols(n, *M);
+            for (Eigen::MatrixXd *M : {&Auu, &Aup, &App})
+                reserve_square(n, *M);
 
-            yu[i].setZero();
-            yp[i].setZero();
+            yu.col(i).setZero();
+            yp.col(i).setZero();
 
             // 1
             //  iters{i}.yu = gmres(As, iters{i}.Rms, iter_gmrs, eps_gm, outer_iter_gmrs);
-            asymmetric_solver->analyze_pattern(As, As.rows());
-            asymmetric_solver->factorize(As);
-            assert(currentRms.size() == yu[i].size());
-            asymmetric_solver->solve(currentRms, yu[i]);
+            asymmetric_solver_->solve(currentRms, yu.col(i));
 
             // 2
             // Rcst = iters{i}.Rcs - Bs' * iters{i}.yu;
-            Rcst = currentRcs - BsT * yu[i];
+            Rcst = currentRcs - BsT * yu.col(i);
 
             // 3
             // iters{i}.yp = bicgstab(Ss, Rcst, eps_cg, 10000);
-            assert(Rcst.size() == yp[i].size());
-            symmetric_solver->solve(Rcst, yp[i]);
+            symmetric_solver_->solve(Rcst, yp.col(i));
 
             // 4
             // Rmst = iters{i}.Rms - Bs*iters{i}.yp;
-            Rmst = currentRms - Bs * yp[i];
+            Rmst = currentRms - Bs * yp.col(i);
 
             // 5
             //  iters{i}.yu = gmres(As, Rmst, iter_gmrs, eps_gm, outer_iter_gmrs);
-            assert(Rmst.size() == yu[i].size());
-            yu[i].setZero();
-            asymmetric_solver->solve(Rmst, yu[i]);
+            yu.col(i).setZero();
+            asymmetric_solver_->solve(Rmst, yu.col(i));
 
             // update
-            Rmu.emplace_back(As * yu[i]);
-            Rmp.emplace_back(Bs * yp[i]);
-            Rcu.emplace_back(BsT * yu[i]);
-            Rcp.emplace_back(Cs * yp[i]);
+            Rmu.col(i) = As * yu.col(i);
+            Rmp.col(i) = Bs * yp.col(i);
+            Rcu.col(i) = BsT * yu.col(i);
+            Rcp.col(i) = Cs * yp.col(i);
 
-            Eigen::MatrixXd Auu = Eigen::MatrixXd::Zero(i + 1, i + 1);
-            Eigen::MatrixXd Aup = Eigen::MatrixXd::Zero(i + 1, i + 1);
-            Eigen::MatrixXd Apu = Eigen::MatrixXd::Zero(i + 1, i + 1);
-            Eigen::MatrixXd App = Eigen::MatrixXd::Zero(i + 1, i + 1);
+            // Only the new row and column of the Gram matrices need to be computed
+            // Auu(k, j) = Rmu[k].dot(Rmu[j]) + Rcu[k].dot(Rcu[j]);
+            // Aup(k, j) = Rmu[k].dot(Rmp[j]) + Rcu[k].dot(Rcp[j]);
+            // App(k, j) = Rmp[k].dot(Rmp[j]) + Rcp[k].dot(Rcp[j]);
+            const auto Rmu_n = Rmu.leftCols(n), Rmp_n = Rmp.leftCols(n);
+            const auto Rcu_n = Rcu.leftCols(n), Rcp_n = Rcp.leftCols(n);
 
-            Eigen::VectorXd bu = Eigen::VectorXd::Zero(i + 1);
-            Eigen::VectorXd bp = Eigen::VectorXd::Zero(i + 1);
+            Auu.col(i).head(n) = Rmu_n.transpose() * Rmu.col(i) + Rcu_n.transpose() * Rcu.col(i);
+            Auu.row(i).head(n) = Auu.col(i).head(n).transpose().eval();
 
-            for (int k = 0; k <= i; ++k)
-            {
-                for (int j = 0; j <= i; ++j)
-                {
-                    Auu(k, j) = Rmu[k].dot(Rmu[j]) + Rcu[k].dot(Rcu[j]);
-                    Aup(k, j) = Rmu[k].dot(Rmp[j]) + Rcu[k].dot(Rcp[j]);
-                    Apu(k, j) = Rmp[k].dot(Rmu[j]) + Rcp[k].dot(Rcu[j]);
-                    App(k, j) = Rmp[k].dot(Rmp[j]) + Rcp[k].dot(Rcp[j]);
-                }
-
-                bu(k) = Rms.dot(Rmu[k]) + Rcs.dot(Rcu[k]);
-                bp(k) = Rms.dot(Rmp[k]) + Rcs.dot(Rcp[k]);
-            }
+            App.col(i).head(n) = Rmp_n.transpose() * Rmp.col(i) + Rcp_n.transpose() * Rcp.col(i);
+            App.row(i).head(n) = App.col(i).head(n).transpose().eval();
+
+            Aup.col(i).head(n) = Rmu_n.transpose() * Rmp.col(i) + Rcu_n.transpose() * Rcp.col(i);
+            Aup.row(i).head(n) = (Rmp_n.transpose() * Rmu.col(i) + Rcp_n.transpose() * Rcu.col(i)).transpose();
+
+            bu.conservativeResize(n);
+            bp.conservativeResize(n);
+            bu(i) = Rms.dot(Rmu.col(i)) + Rcs.dot(Rcu.col(i));
+            bp(i) = Rms.dot(Rmp.col(i)) + Rcs.dot(Rcp.col(i));
 
             // Ao = [Auu Aup; Apu App];
             // bo = [bu; bp];
-            Eigen::MatrixXd A(2 * (i + 1), 2 * (i + 1));
-            Eigen::VectorXd b(2 * (i + 1));
+            Eigen::MatrixXd A(2 * n, 2 * n);
+            Eigen::VectorXd b(2 * n);
 
-            A.topLeftCorner(i + 1, i + 1) = Auu;
-            A.topRightCorner(i + 1, i + 1) = Aup;
-            A.bottomLeftCorner(i + 1, i + 1) = Apu;
-            A.bottomRightCorner(i + 1, i + 1) = App;
+            A.topLeftCorner(n, n) = Auu.topLeftCorner(n, n);
+            A.topRightCorner(n, n) = Aup.topLeftCorner(n, n);
+            A.bottomLeftCorner(n, n) = Aup.topLeftCorner(n, n).transpose();
+            A.bottomRightCorner(n, n) = App.topLeftCorner(n, n);
 
-            b.topRows(i + 1) = bu;
-            b.bottomRows(i + 1) = bp;
+            b.topRows(n) = bu;
+            b.bottomRows(n) = bp;
 
             // alpha = A\b;
             Eigen::VectorXd alpha = A.ldlt().solve(b);
-            // small_solver->analyze_pattern(A, A.rows());
-            // small_solver->solve(b, alpha);
 
             // alphau = alpha(1:i);
             // alphap = alpha(i+1:end);
-            alphau = alpha.topRows(i + 1);
-            alphap = alpha.bottomRows(i + 1);
+            alphau = alpha.topRows(n);
+            alphap = alpha.bottomRows(n);
+
+            // iters{i+1}.Rms = Rms - sum_j alphau(j)*iters{j}.Rmu + alphap(j)*iters{j}.Rmp;
+            // iters{i+1}.Rcs = Rcs - sum_j alphau(j)*iters{j}.Rcu + alphap(j)*iters{j}.Rcp;
+            currentRms = Rms - Rmu_n * alphau - Rmp_n * alphap;
+            currentRcs = Rcs - Rcu_n * alphau - Rcp_n * alphap;
 
-            // TODO stopping condition!
-            compute_solution(i + 1, alphau, alphap, yu, yp, Wm, Wc, result);
-            final_res_norm_ = (Ain_ * result - rhs).norm();
+            // This is the residual of the scaled system, unscale it to get the one of the input system
+            final_res_norm_ = std::sqrt((Wm_inv.array() * currentRms.array()).matrix().squaredNorm()
+                                        + (Wc_inv.array() * currentRcs.array()).matrix().squaredNorm());
 
             if (final_res_norm_ < conv_tol_)
             {
+                ++i;
                 break;
             }
-
-            // iters{i+1}.Rms = Rms;
-            // iters{i+1}.Rcs = Rcs;
-            currentRms = Rms;
-            currentRcs = Rcs;
-
-            for (int j = 0; j <= i; ++j)
-            {
-                // iters{i+1}.Rms = iters{i+1}.Rms - alphau(j)*iters{j}.Rmu - alphap(j)*iters{j}.Rmp;
-                // iters{i+1}.Rcs = iters{i+1}.Rcs - alphau(j)*iters{j}.Rcu - alphap(j)*iters{j}.Rcp;
-                currentRms -= alphau(j) * Rmu[j] + alphap(j) * Rmp[j];
-                currentRcs -= alphau(j) * Rcu[j] + alphap(j) * Rcp[j];
-            }
         }
 
-        max_iter_ = i;
-        // compute_solution(i, alphau, alphap, yu, yp, Wm, Wc, result);
+        num_iterations_ = i;
+
+        // yu = sum_j alphau(j) * iters{j}.yu;
+        // yp = sum_j alphap(j) * iters{j}.yp;
+        result.head(m_size) = Wm * (yu.leftCols(alphau.size()) * alphau);
+        result.tail(c_size) = Wc * (yp.leftCols(alphap.size()) * alphap);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,7 @@
 #include "Solver.hpp"
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <memory>
 #include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +13,8 @@
 namespace polysolve::linear
 {
 
+    // Solver for symmetric saddle point systems [A B; Bᵀ C], where A is the leading precond_num
+    // rows and columns. The lower-left block is assumed to be Bᵀ and is never read.
     class SaddlePointSolver : public Solver
     {
 
@@ -46,8 +49,6 @@ namespace polysolve::linear
         virtual std::string name() const override { return "SaddlePointSolver"; }
 
     private:
-        StiffnessMatrix Ain_;
-
         StiffnessMatrix As;
         StiffnessMatrix Bs;
         StiffnessMatrix BsT;
@@ -56,6 +57,8 @@ namespace polysolve::linear
 
         StiffnessMatrix Wm;
         StiffnessMatrix Wc;
+        Eigen::VectorXd Wm_inv;
+        Eigen::VectorXd Wc_inv;
 
         int max_iter_;
         double conv_tol_;
@@ -68,6 +71,10 @@ namespace polysolve::linear
         json asymmetric_solver_params_;
         json symmetric_solver_params_;
 
+        // Inner solvers, factorized once per factorization
+        std::unique_ptr<Solver> asymmetric_solver_;
+        std::unique_ptr<Solver> symmetric_solver_;
+
         double final_res_norm_;
         int num_iterations_;
     };
@@ -4,6 +4,7 @@
 #include "Solver.hpp"
 #include "EigenSolver.hpp"
 #include "SaddlePointSolver.hpp"
+#include "MixedPrecisionRefinement.hpp"
 
 #include <jse/jse.h>
 #include <spdlog/spdlog.h>
@@ -109,23 +110,35 @@ namespace polysolve::linear
         }
     }
 
+    const json &Solver::spec_rules(spdlog::logger &logger)
+    {
+        // Thread-safe initialization, retried on the next call if the file cannot be read
+        static const json rules = [&logger]() {
+            json rules;
+            const std::string input_spec = POLYSOLVE_LINEAR_SPEC;
+            std::ifstream file(input_spec);
+
+            if (file.is_open())
+                file >> rules;
+            else
+                log_and_throw_error(logger, "unable to open {} rules", input_spec);
+
+            apply_default_solver(rules);
+            return rules;
+        }();
+
+        return rules;
+    }
+
     std::unique_ptr<Solver> Solver::create(const json &params_in, spdlog::logger &logger, const bool strict_validation)
     {
         json params = params_in; // mutable copy
 
-        json rules;
+        const json &rules = spec_rules(logger);
         jse::JSE jse;
 
         jse.strict = strict_validation;
-        const std::string input_spec = POLYSOLVE_LINEAR_SPEC;
-        std::ifstream file(input_spec);
-
-        if (file.is_open())
-            file >> rules;
-        else
-            log_and_throw_error(logger, "unable to open {} rules", input_spec);
 
-        apply_default_solver(rules);
         select_valid_solver(params, logger);
 
         const bool valid_input = jse.verify_json(params, rules);
@@ -141,6 +154,25 @@ namespace polysolve::linear
         return res;
     }
 
+    void Solver::set_vertex_coordinates(const Eigen::MatrixXd &V)
+    {
+        set_near_nullspace(rigid_body_modes(V));
+    }
+
+    void Solver::factorize_operator(const LinearOperator &A)
+    {
+        throw std::runtime_error(fmt::format("[{}] matrix-free operators are not supported", name()));
+    }
+
+    void Solver::solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X)
+    {
+        if (X.rows() != B.rows() || X.cols() != B.cols())
+            X.setZero(B.rows(), B.cols());
+
+        for (Eigen::Index i = 0; i < B.cols(); ++i)
+            solve(B.col(i), X.col(i));
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
 
 #if EIGEN_VERSION_AT_LEAST(3, 3, 0)
@@ -413,6 +445,10 @@ namespace polysolve::linear
         {
             return std::make_unique<SaddlePointSolver>();
         }
+        else if (solver == "MixedPrecisionRefinement")
+        {
+            return std::make_unique<MixedPrecisionRefinement>();
+        }
         /////DENSE Eigen
         else if (solver == "Eigen::PartialPivLU")
         {
@@ -465,6 +501,7 @@ namespace polysolve::linear
         return {{
             "Eigen::SimplicialLDLT",
             "Eigen::SparseLU",
+            "MixedPrecisionRefinement",
 #ifdef POLYSOLVE_WITH_ACCELERATE
             "Eigen::AccelerateLLT",
             "Eigen::AccelerateLDLT",
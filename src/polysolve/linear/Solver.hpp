@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polysolve/Types.hpp>
+#include "LinearOperator.hpp"
 
 #include <memory>
 
@@ -51,6 +52,9 @@ namespace polysolve::linear
         /// Selects the correct solver based on params using the fallback or the list of solvers if necessary
         static void select_valid_solver(json &params, spdlog::logger &logger);
 
+        /// Rules of the linear solver spec with the defaults applied, read once and shared by all calls
+        static const json &spec_rules(spdlog::logger &logger);
+
         // Static constructor
         //
         // @param[in]  params   Parameter of the solver, including name and preconditioner
@@ -98,6 +102,10 @@ namespace polysolve::linear
         // Factorize system matrix
         virtual void factorize(const StiffnessMatrix &A) {}
 
+        // Factorize A + sigma I, reusing the symbolic analysis of the sparsity pattern of A. Returns false
+        // if the solver cannot apply the shift itself, in which case the caller factorizes the shifted matrix.
+        virtual bool refactorize_shifted(const StiffnessMatrix &A, const double sigma) { return false; }
+
         // Analyze sparsity pattern of a dense matrix
         virtual void analyze_pattern_dense(const Eigen::MatrixXd &A, const int precond_num) {}
 
@@ -107,6 +115,26 @@ namespace polysolve::linear
         // If solver uses dense matrices
         virtual bool is_dense() const { return false; }
 
+        // If solver can use a LinearOperator instead of an assembled matrix
+        virtual bool supports_matrix_free() const { return false; }
+
+        // Setup the solver for a matrix-free operator, which must outlive the subsequent solves.
+        // Throws if the solver needs an assembled matrix.
+        virtual void factorize_operator(const LinearOperator &A);
+
+        // Set the near-nullspace of the system matrix (e.g., rigid body modes in elasticity),
+        // one vector per column. Ignored by solvers that do not use one; algebraic multigrid
+        // preconditioners throw if they cannot use B (e.g., AMGCL block types, or Hypre without translations).
+        virtual void set_near_nullspace(const Eigen::MatrixXd &B) {}
+
+        // Set the coordinates of the vertices (#V x dim) of a vector problem whose unknowns are
+        // interleaved per vertex. By default, sets their rigid body modes as near-nullspace.
+        virtual void set_vertex_coordinates(const Eigen::MatrixXd &V);
+
+        // Set the relative residual tolerance (‖Ax - b‖ ≤ tol ‖b‖) of the next solves, overriding
+        // the one from the parameters (e.g., for inexact Newton). Ignored by direct solvers.
+        virtual void set_tolerance(const double tol) {}
+
         //
         // @brief         { Solve the linear system Ax = b }
         //
@@ -118,6 +146,20 @@ namespace polysolve::linear
         //
         virtual void solve(const Ref<const VectorXd> b, Ref<VectorXd> x) = 0;
 
+        //
+        // @brief         { Solve the linear system AX = B for multiple right-hand sides }
+        //
+        // @param[in]     B     { Right-hand sides, one per column. }
+        // @param[in,out] X     { Unknowns to compute, one per column. If X has
+        //                      the same size as B, its columns are used as
+        //                      initial guesses by iterative solvers; otherwise
+        //                      it is resized and zero-initialized. }
+        //
+        // The default implementation calls the single right-hand side solve
+        // on each column.
+        //
+        virtual void solve(const Ref<const Eigen::MatrixXd> B, Eigen::MatrixXd &X);
+
     public:
         ///////////
         // Debug //
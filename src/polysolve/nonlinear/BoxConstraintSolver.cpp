@@ -6,8 +6,6 @@
 #include <jse/jse.h>
 #include <polysolve/JSONUtils.hpp>
 
-#include <fstream>
-
 namespace polysolve::nonlinear
 {
 
@@ -21,17 +19,10 @@ namespace polysolve::nonlinear
     {
         json solver_params = solver_params_in; // mutable copy
 
-        json rules;
+        const json &rules = spec_rules(logger);
         jse::JSE jse;
 
         jse.strict = strict_validation;
-        const std::string input_spec = POLYSOLVE_NON_LINEAR_SPEC;
-        std::ifstream file(input_spec);
-
-        if (file.is_open())
-            file >> rules;
-        else
-            log_and_throw_error(logger, "unable to open {} rules", input_spec);
 
         const bool valid_input = jse.verify_json(solver_params, rules);
 
@@ -2,6 +2,16 @@
 
 namespace polysolve::nonlinear
 {
+    void Problem::compute(const TVector &x, double *f, TVector *gradv, THessian *hessian)
+    {
+        if (f)
+            *f = value(x);
+        if (gradv)
+            gradient(x, *gradv);
+        if (hessian)
+            this->hessian(x, *hessian);
+    }
+
     void Problem::sample_along_direction(
         const Problem::TVector &x,
         const Problem::TVector &direction,
@@ -30,6 +30,15 @@ namespace polysolve::nonlinear
         virtual void gradient(const TVector &x, TVector &gradv) override = 0;
         virtual void hessian(const TVector &x, THessian &hessian) = 0;
 
+        // Evaluates f(x), ∇f(x) and ∇²f(x) in a single call, skipping the outputs that are nullptr.
+        // Override to share the work common to them (e.g., a single loop over the elements);
+        // by default, forwards to value, gradient and hessian.
+        virtual void compute(const TVector &x, double *f, TVector *gradv, THessian *hessian);
+
+        // Computes ∇²f(x) v without assembling the Hessian. Returns false if not supported (default),
+        // in which case matrix-free solvers assemble the Hessian instead.
+        virtual bool hessian_vector_product(const TVector &x, const TVector &v, TVector &hv) { return false; }
+
         virtual bool is_step_valid(const TVector &x0, const TVector &x1) const { return true; }
         virtual double max_step_size(const TVector &x0, const TVector &x1) const { return 1; }
 
@@ -37,10 +46,37 @@ namespace polysolve::nonlinear
         virtual void line_search_end() {}
         virtual void post_step(const PostStepData &data) {}
 
+        // Whether the problem calls invalidate_objective whenever post_step or solution_changed change f
+        // or ∇f at a fixed x (e.g., by updating a penalty stiffness). If true, the solver reuses f(x) and
+        // ∇f(x) computed after the step unless they were invalidated, otherwise it recomputes them at the
+        // start of every iteration.
+        virtual bool signals_objective_changes() const { return false; }
+
+        // Marks f and ∇f evaluated by the solver at the current x as outdated
+        void invalidate_objective() { is_objective_invalidated = true; }
+
+        // Whether invalidate_objective was called since the last call, and clears it
+        bool take_objective_invalidation()
+        {
+            const bool invalidated = is_objective_invalidated;
+            is_objective_invalidated = false;
+            return invalidated;
+        }
+
         virtual void set_project_to_psd(bool val) {}
 
         virtual void solution_changed(const TVector &new_x) {}
 
+        // Whether line searches can evaluate trial steps concurrently. Each trial is then evaluated on a
+        // worker thread thread_id in [0, parallel_trials) as trial_solution_changed(x1, thread_id),
+        // is_step_valid(x0, x1), then value(x1) or compute(x1, ...) without Hessian, all on that thread.
+        // State updated by solution_changed (e.g., a constraint set) must be kept per thread_id, and
+        // solution_changed is still called on the calling thread before checking the step criteria.
+        virtual bool is_thread_safe() const { return false; }
+
+        // Same as solution_changed, for the state of worker thread_id only
+        virtual void trial_solution_changed(const TVector &new_x, const int thread_id) {}
+
         virtual bool stop(const TVector &x) { return false; }
 
         void sample_along_direction(
@@ -52,5 +88,8 @@ namespace polysolve::nonlinear
             Eigen::VectorXd &alphas,
             Eigen::VectorXd &fs,
             Eigen::VectorXi &valid);
+
+    private:
+        bool is_objective_invalidated = false;
     };
 } // namespace polysolve::nonlinear
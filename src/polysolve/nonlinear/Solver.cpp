@@ -5,9 +5,11 @@
 
 #include "descent_strategies/BFGS.hpp"
 #include "descent_strategies/Newton.hpp"
+#include "descent_strategies/ModifiedNewton.hpp"
 #include "descent_strategies/ADAM.hpp"
 #include "descent_strategies/GradientDescent.hpp"
 #include "descent_strategies/LBFGS.hpp"
+#include "descent_strategies/TrustRegionNewtonCG.hpp"
 
 #include <polysolve/Utils.hpp>
 
@@ -35,8 +37,7 @@ namespace polysolve::nonlinear
             if (solver_name == "BFGS")
             {
                 return std::make_shared<BFGS>(
-                    solver_params, linear_solver_params,
-                    characteristic_length, logger);
+                    solver_params, characteristic_length, logger);
             }
 
             else if (solver_name == "DenseNewton" || solver_name == "dense_newton")
@@ -73,9 +74,19 @@ namespace polysolve::nonlinear
                 return std::make_shared<RegularizedNewton>(true, true, solver_params, linear_solver_params, characteristic_length, logger);
             }
 
+            else if (solver_name == "ModifiedNewton")
+            {
+                return std::make_shared<ModifiedNewton>(solver_params, linear_solver_params, characteristic_length, logger);
+            }
+
+            else if (solver_name == "TrustRegionNewtonCG")
+            {
+                return std::make_shared<TrustRegionNewtonCG>(solver_params, characteristic_length, logger);
+            }
+
             else if (solver_name == "LBFGS" || solver_name == "L-BFGS")
             {
-                return std::make_shared<LBFGS>(solver_params, characteristic_length, logger);
+                return std::make_shared<LBFGS>(solver_params, linear_solver_params, characteristic_length, logger);
             }
 
             else if (solver_name == "StochasticGradientDescent" || solver_name == "stochastic_gradient_descent")
@@ -107,6 +118,25 @@ namespace polysolve::nonlinear
          {FiniteDiffStrategy::DIRECTIONAL_DERIVATIVE, "DirectionalDerivative"},
          {FiniteDiffStrategy::FULL_FINITE_DIFF, "FullFiniteDiff"}})
 
+    const json &Solver::spec_rules(spdlog::logger &logger)
+    {
+        // Thread-safe initialization, retried on the next call if the file cannot be read
+        static const json rules = [&logger]() {
+            json rules;
+            const std::string input_spec = POLYSOLVE_NON_LINEAR_SPEC;
+            std::ifstream file(input_spec);
+
+            if (file.is_open())
+                file >> rules;
+            else
+                log_and_throw_error(logger, "unable to open {} rules", input_spec);
+
+            return rules;
+        }();
+
+        return rules;
+    }
+
     // Static constructor
     std::unique_ptr<Solver> Solver::create(
         const json &solver_params_in,
@@ -117,17 +147,10 @@ namespace polysolve::nonlinear
     {
         json solver_params = solver_params_in; // mutable copy
 
-        json rules;
+        const json &rules = spec_rules(logger);
         jse::JSE jse;
 
         jse.strict = strict_validation;
-        const std::string input_spec = POLYSOLVE_NON_LINEAR_SPEC;
-        std::ifstream file(input_spec);
-
-        if (file.is_open())
-            file >> rules;
-        else
-            log_and_throw_error(logger, "unable to open {} rules", input_spec);
 
         const bool valid_input = jse.verify_json(solver_params, rules);
 
@@ -184,6 +207,8 @@ namespace polysolve::nonlinear
         return {"BFGS",
                 "DenseNewton",
                 "Newton",
+                "ModifiedNewton",
+                "TrustRegionNewtonCG",
                 "ADAM",
                 "StochasticADAM",
                 "GradientDescent",
@@ -264,6 +289,7 @@ namespace polysolve::nonlinear
         reset(x.size()); // place for children to initialize their fields
 
         m_line_search->use_grad_norm_tol = use_grad_norm_tol;
+        m_line_search->reset();
 
         TVector grad = TVector::Zero(x.rows());
         TVector delta_x = TVector::Zero(x.rows());
@@ -277,17 +303,13 @@ namespace polysolve::nonlinear
 
         double energy;
         {
-            POLYSOLVE_SCOPED_STOPWATCH("compute objective function", obj_fun_time, m_logger);
-            energy = objFunc.value(x);
+            POLYSOLVE_SCOPED_STOPWATCH("compute objective function and gradient", obj_fun_time, m_logger);
+            objFunc.take_objective_invalidation(); // the evaluation below sees all changes so far
+            objFunc.compute(x, &energy, &grad, nullptr);
         }
 
-        double grad_norm;
-        {
-            POLYSOLVE_SCOPED_STOPWATCH("compute gradient", grad_time, m_logger);
-            objFunc.gradient(x, grad);
-            grad_norm = compute_grad_norm(x, grad);
-            this->m_current.gradNorm = grad_norm;
-        }
+        double grad_norm = compute_grad_norm(x, grad);
+        this->m_current.gradNorm = grad_norm;
 
         const auto g_norm_tol = this->m_stop.gradNorm;
         this->m_stop.gradNorm = first_grad_norm_tol;
@@ -305,6 +327,10 @@ namespace polysolve::nonlinear
         update_solver_info(energy);
         objFunc.post_step(PostStepData(this->m_current.iterations, solver_info, x, grad));
 
+        // energy and grad are f(x) and ∇f(x) for the current x: they are recomputed after post_step
+        // if the problem invalidated them, or always if it does not signal its changes
+        bool is_evaluation_valid = objFunc.signals_objective_changes() && !objFunc.take_objective_invalidation();
+
         int f_delta_step_cnt = 0;
         double f_delta = 0;
 
@@ -316,10 +342,13 @@ namespace polysolve::nonlinear
             this->m_current.fDelta = NaN;
             this->m_current.gradNorm = NaN;
 
-            //////////// Energy
+            //////////// Energy and gradient
+            if (!is_evaluation_valid)
             {
-                POLYSOLVE_SCOPED_STOPWATCH("compute objective function", obj_fun_time, m_logger);
-                energy = objFunc.value(x);
+                POLYSOLVE_SCOPED_STOPWATCH("compute objective function and gradient", obj_fun_time, m_logger);
+                objFunc.take_objective_invalidation();
+                objFunc.compute(x, &energy, &grad, nullptr);
+                is_evaluation_valid = true;
             }
 
             if (!std::isfinite(energy))
@@ -334,12 +363,6 @@ namespace polysolve::nonlinear
             // stop based on f_delta only if the solver has taken over f_delta_step_tol steps with small f_delta
             this->m_current.fDelta = (f_delta_step_cnt >= f_delta_step_tol) ? f_delta : NaN;
 
-            ///////////// gradient
-            {
-                POLYSOLVE_SCOPED_STOPWATCH("compute gradient", grad_time, m_logger);
-                objFunc.gradient(x, grad);
-            }
-
             {
                 POLYSOLVE_SCOPED_STOPWATCH("verify gradient", grad_time, m_logger);
                 this->verify_gradient(objFunc, x, grad);
@@ -418,7 +441,7 @@ namespace polysolve::nonlinear
             // ---------------
 
             // Perform a line_search to compute step scale
-            double rate = m_line_search->line_search(x, delta_x, objFunc);
+            double rate = m_line_search->line_search(x, delta_x, objFunc, energy, grad);
             if (std::isnan(rate))
             {
                 const auto current_name = descent_strategy_name();
@@ -438,19 +461,14 @@ namespace polysolve::nonlinear
             x += rate * delta_x;
             old_energy = energy;
 
-            //////////// Energy
-            {
-                POLYSOLVE_SCOPED_STOPWATCH("compute objective function", obj_fun_time, m_logger);
-                energy = objFunc.value(x);
-            }
-
-            ///////////// gradient
+            //////////// Energy and gradient
             {
-                POLYSOLVE_SCOPED_STOPWATCH("compute gradient", grad_time, m_logger);
-                objFunc.gradient(x, grad);
-                grad_norm = compute_grad_norm(x, grad);
-                this->m_current.gradNorm = grad_norm;
+                POLYSOLVE_SCOPED_STOPWATCH("compute objective function and gradient", obj_fun_time, m_logger);
+                objFunc.take_objective_invalidation(); // e.g., from solution_changed during the line search
+                objFunc.compute(x, &energy, &grad, nullptr);
             }
+            grad_norm = compute_grad_norm(x, grad);
+            this->m_current.gradNorm = grad_norm;
 
             // Reset this for the next iterations
             // if the strategy got changed, we start counting
@@ -482,6 +500,7 @@ namespace polysolve::nonlinear
 
             update_solver_info(energy);
             objFunc.post_step(PostStepData(this->m_current.iterations, solver_info, x, grad));
+            is_evaluation_valid = objFunc.signals_objective_changes() && !objFunc.take_objective_invalidation();
 
             if (objFunc.stop(x))
             {
@@ -533,7 +552,7 @@ namespace polysolve::nonlinear
             this->m_stop.iterations, this->m_stop.fDelta, this->m_stop.gradNorm, this->m_stop.xDelta);
 
         log_times();
-        update_solver_info(objFunc.value(x));
+        update_solver_info(is_evaluation_valid ? energy : objFunc.value(x));
     }
 
     void Solver::reset(const int ndof)
@@ -46,6 +46,9 @@ namespace polysolve::nonlinear
         // List available solvers
         static std::vector<std::string> available_solvers();
 
+        // Rules of the nonlinear solver spec, read once and shared by all calls
+        static const json &spec_rules(spdlog::logger &logger);
+
         using Superclass = ISolver<Problem, /*Ord=*/-1>;
         using typename Superclass::Scalar;
         using typename Superclass::TCriteria;
@@ -6,14 +6,13 @@ namespace polysolve::nonlinear
 {
 
     BFGS::BFGS(const json &solver_params,
-               const json &linear_solver_params,
                const double characteristic_length,
                spdlog::logger &logger)
         : Superclass(solver_params, characteristic_length, logger)
     {
-        linear_solver = polysolve::linear::Solver::create(linear_solver_params, logger);
-        if (!linear_solver->is_dense())
-            log_and_throw_error(logger, "BFGS linear solver must be dense, instead got {}", linear_solver->name());
+        m_compact_history = extract_param("BFGS", "compact_history", solver_params);
+        if (m_compact_history < 0)
+            log_and_throw_error(logger, "BFGS compact_history must be >=0, instead got {}", m_compact_history);
     }
 
     void BFGS::reset(const int ndof)
@@ -27,7 +26,16 @@ namespace polysolve::nonlinear
         m_prev_x.resize(0);
         m_prev_grad.resize(ndof);
 
-        hess.setIdentity(ndof, ndof);
+        if (m_compact_history > 0)
+        {
+            m_bfgs.reset(ndof, m_compact_history);
+            inv_hess.resize(0, 0);
+        }
+        else
+        {
+            inv_hess.setIdentity(ndof, ndof);
+        }
+        is_scaled = false;
     }
 
     bool BFGS::compute_update_direction(
@@ -42,31 +50,60 @@ namespace polysolve::nonlinear
         }
         else
         {
-            try
+            const TVector s = x - m_prev_x;
+            const TVector y = grad - m_prev_grad;
+
+            if (m_compact_history > 0)
             {
-                linear_solver->analyze_pattern_dense(hess, hess.rows());
-                linear_solver->factorize_dense(hess);
-                linear_solver->solve(-grad, direction);
+                if (has_positive_curvature(s, y))
+                    m_bfgs.add_correction(s, y);
+                m_bfgs.apply_Hv(grad, -Scalar(1), direction);
             }
-            catch (const std::runtime_error &err)
+            else
             {
-                m_logger.debug("Unable to factorize Hessian: \"{}\";", err.what());
-                return false;
+                update_inverse_hessian(s, y);
+                direction.noalias() = -(inv_hess.selfadjointView<Eigen::Lower>() * grad);
             }
-
-            TVector y = grad - m_prev_grad;
-            TVector s = x - m_prev_x;
-
-            double y_s = y.dot(s);
-            TVector Bs = hess * s;
-            double sBs = s.transpose() * Bs;
-
-            hess += (y * y.transpose()) / y_s - (Bs * Bs.transpose()) / sBs;
         }
 
         m_prev_x = x;
         m_prev_grad = grad;
 
+        return direction.allFinite();
+    }
+
+    bool BFGS::has_positive_curvature(const TVector &s, const TVector &y) const
+    {
+        const double y_s = y.dot(s);
+        if (y_s <= 1e-12 * s.norm() * y.norm())
+        {
+            // The curvature condition does not hold, the update would not be positive definite
+            m_logger.trace("[{}] skipping update with sᵀy={:g}", name(), y_s);
+            return false;
+        }
         return true;
     }
+
+    void BFGS::update_inverse_hessian(const TVector &s, const TVector &y)
+    {
+        if (!has_positive_curvature(s, y))
+            return;
+
+        const double y_s = y.dot(s);
+
+        if (!is_scaled)
+        {
+            // Scale the initial inverse Hessian with sᵀy / yᵀy, see Nocedal and Wright, Eq. 6.20
+            inv_hess.diagonal().setConstant(y_s / y.squaredNorm());
+            is_scaled = true;
+        }
+
+        // H ← (I - ρ s yᵀ) H (I - ρ y sᵀ) + ρ s sᵀ = H - ρ (H y sᵀ + s yᵀH) + (ρ² yᵀHy + ρ) s sᵀ
+        const double rho = 1 / y_s;
+        const TVector Hy = inv_hess.selfadjointView<Eigen::Lower>() * y;
+        const double yHy = y.dot(Hy);
+
+        inv_hess.selfadjointView<Eigen::Lower>().rankUpdate(Hy, s, -rho);
+        inv_hess.selfadjointView<Eigen::Lower>().rankUpdate(s, rho * rho * yHy + rho);
+    }
 } // namespace polysolve::nonlinear
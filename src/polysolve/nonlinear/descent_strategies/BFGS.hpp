@@ -5,19 +5,18 @@
 #include "DescentStrategy.hpp"
 #include <polysolve/Utils.hpp>
 
-#include <polysolve/linear/Solver.hpp>
-
 #include <LBFGSpp/BFGSMat.h>
 
 namespace polysolve::nonlinear
 {
+    /// @brief BFGS keeping an approximation of the inverse Hessian, updated in O(n²) per iteration.
+    /// With compact_history > 0, the compact limited-memory form of the last updates is used instead.
     class BFGS : public DescentStrategy
     {
     public:
         using Superclass = DescentStrategy;
 
         BFGS(const json &solver_params,
-             const json &linear_solver_params,
              const double characteristic_length,
              spdlog::logger &logger);
 
@@ -35,10 +34,19 @@ namespace polysolve::nonlinear
         TVector m_prev_x;    // Previous x
         TVector m_prev_grad; // Previous gradient
 
-        Eigen::MatrixXd hess;
+        int m_compact_history; ///< Number of corrections of the compact form, 0 for the dense inverse
+
+        Eigen::MatrixXd inv_hess; ///< Dense inverse Hessian approximation, only the lower triangle is used
+        bool is_scaled;           ///< Whether the initial inverse Hessian has been scaled
+
+        LBFGSpp::BFGSMat<Scalar> m_bfgs; ///< Compact limited-memory form
 
         void reset_history(const int ndof);
 
-        std::unique_ptr<polysolve::linear::Solver> linear_solver; ///< Linear solver used to solve the linear system
+        // Whether sᵀy > 0, otherwise the update with (s, y) is skipped
+        bool has_positive_curvature(const TVector &s, const TVector &y) const;
+
+        // Rank-2 update of the inverse Hessian with the step s and the gradient change y
+        void update_inverse_hessian(const TVector &s, const TVector &y);
     };
 } // namespace polysolve::nonlinear
@@ -7,6 +7,7 @@
 namespace polysolve::nonlinear
 {
     LBFGS::LBFGS(const json &solver_params,
+                 const json &linear_solver_params,
                  const double characteristic_length,
                  spdlog::logger &logger)
         : Superclass(solver_params,
@@ -16,6 +17,17 @@ namespace polysolve::nonlinear
         m_history_size = extract_param("L-BFGS", "history_size", solver_params);
         if (m_history_size <= 0)
             log_and_throw_error(logger, "L-BFGS history_size must be >=1, instead got {}", m_history_size);
+
+        m_preconditioner_refresh = extract_param("L-BFGS", "preconditioner_refresh", solver_params);
+        if (m_preconditioner_refresh < 0)
+            log_and_throw_error(logger, "L-BFGS preconditioner_refresh must be >=0, instead got {}", m_preconditioner_refresh);
+
+        if (m_preconditioner_refresh > 0)
+        {
+            linear_solver = polysolve::linear::Solver::create(linear_solver_params, logger);
+            if (linear_solver->is_dense())
+                log_and_throw_error(logger, "L-BFGS linear solver must be sparse, instead got {}", linear_solver->name());
+        }
     }
 
     void LBFGS::reset(const int ndof)
@@ -24,6 +36,11 @@ namespace polysolve::nonlinear
 
         m_bfgs.reset(ndof, m_history_size);
         m_prev_x.resize(0);
+
+        m_s.clear();
+        m_y.clear();
+        m_iterations_since_refresh = m_preconditioner_refresh; // assemble at the first iteration
+        m_factorizations = 0;
     }
 
     bool LBFGS::compute_update_direction(
@@ -32,7 +49,41 @@ namespace polysolve::nonlinear
         const TVector &grad,
         TVector &direction)
     {
-        if (m_prev_x.size() == 0)
+        if (m_preconditioner_refresh > 0)
+        {
+            if (m_prev_x.size() != 0)
+            {
+                assert(m_prev_x.size() == x.size());
+                assert(m_prev_grad.size() == grad.size());
+
+                const TVector s = x - m_prev_x;
+                const TVector y = grad - m_prev_grad;
+                // Skip pairs violating the curvature condition, as LBFGSpp does
+                if (s.dot(y) > std::numeric_limits<Scalar>::epsilon() * y.squaredNorm())
+                {
+                    m_s.push_back(s);
+                    m_y.push_back(y);
+                    if (int(m_s.size()) > m_history_size)
+                    {
+                        m_s.pop_front();
+                        m_y.pop_front();
+                    }
+                }
+            }
+
+            if (m_iterations_since_refresh >= m_preconditioner_refresh)
+            {
+                if (!refresh_preconditioner(objFunc, x))
+                    return false;
+            }
+            ++m_iterations_since_refresh;
+
+            {
+                POLYSOLVE_SCOPED_STOPWATCH("linear solve", inverting_time, m_logger);
+                apply_preconditioned_inverse(grad, direction);
+            }
+        }
+        else if (m_prev_x.size() == 0)
         {
             // Use gradient descent in the first iteration or if the previous iteration failed
             direction = -grad;
@@ -53,6 +104,66 @@ namespace polysolve::nonlinear
         m_prev_x = x;
         m_prev_grad = grad;
 
+        return direction.allFinite();
+    }
+
+    bool LBFGS::refresh_preconditioner(Problem &objFunc, const TVector &x)
+    {
+        m_iterations_since_refresh = 0;
+
+        polysolve::StiffnessMatrix hessian;
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("assembly time", assembly_time, m_logger);
+            // H₀ must be positive definite for the directions to be descent directions
+            objFunc.set_project_to_psd(true);
+            objFunc.compute(x, nullptr, nullptr, &hessian);
+        }
+
+        POLYSOLVE_SCOPED_STOPWATCH("linear solve", inverting_time, m_logger);
+
+        if (!m_hessian_pattern.factorize(*linear_solver, hessian, m_logger))
+            return false;
+
+        ++m_factorizations;
         return true;
     }
+
+    void LBFGS::apply_preconditioned_inverse(const TVector &grad, TVector &direction)
+    {
+        // See Nocedal and Wright, Algorithm 7.4
+        const int k = m_s.size();
+        std::vector<Scalar> alpha(k), rho(k);
+
+        TVector q = grad;
+        for (int i = k - 1; i >= 0; --i)
+        {
+            rho[i] = 1 / m_y[i].dot(m_s[i]);
+            alpha[i] = rho[i] * m_s[i].dot(q);
+            q -= alpha[i] * m_y[i];
+        }
+
+        TVector r(q.size());
+        r.setZero();
+        linear_solver->solve(q, r);
+
+        for (int i = 0; i < k; ++i)
+        {
+            const Scalar beta = rho[i] * m_y[i].dot(r);
+            r += (alpha[i] - beta) * m_s[i];
+        }
+
+        direction = -r;
+    }
+
+    void LBFGS::update_solver_info(json &solver_info, const double per_iteration)
+    {
+        Superclass::update_solver_info(solver_info, per_iteration);
+
+        if (m_preconditioner_refresh > 0)
+        {
+            solver_info["factorizations"] = m_factorizations;
+            solver_info["time_assembly"] = assembly_time / per_iteration;
+            solver_info["time_inverting"] = inverting_time / per_iteration;
+        }
+    }
 } // namespace polysolve::nonlinear
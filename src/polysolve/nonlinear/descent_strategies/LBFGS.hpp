@@ -3,10 +3,15 @@
 #pragma once
 
 #include "DescentStrategy.hpp"
+#include "SparsityPatternCache.hpp"
 #include <polysolve/Utils.hpp>
 
+#include <polysolve/linear/Solver.hpp>
+
 #include <LBFGSpp/BFGSMat.h>
 
+#include <deque>
+
 namespace polysolve::nonlinear
 {
     class LBFGS : public DescentStrategy
@@ -15,6 +20,7 @@ namespace polysolve::nonlinear
         using Superclass = DescentStrategy;
 
         LBFGS(const json &solver_params,
+              const json &linear_solver_params,
               const double characteristic_length,
               spdlog::logger &logger);
 
@@ -22,6 +28,13 @@ namespace polysolve::nonlinear
 
     public:
         void reset(const int ndof) override;
+        void update_solver_info(json &solver_info, const double per_iteration) override;
+
+        void reset_times() override
+        {
+            assembly_time = 0;
+            inverting_time = 0;
+        }
 
         bool compute_update_direction(
             Problem &objFunc,
@@ -42,5 +55,25 @@ namespace polysolve::nonlinear
 
         TVector m_prev_x;    // Previous x
         TVector m_prev_grad; // Previous gradient
+
+        // Preconditioned variant, where the initial Hessian is the sparse Hessian assembled every
+        // m_preconditioner_refresh iterations (0 uses the scalar initial Hessian of m_bfgs)
+        int m_preconditioner_refresh;
+        std::unique_ptr<polysolve::linear::Solver> linear_solver; ///< Holds the factorization of the initial Hessian
+        int m_iterations_since_refresh;
+        SparsityPatternCache m_hessian_pattern;
+        int m_factorizations;
+
+        std::deque<TVector> m_s; ///< Steps of the preconditioned variant
+        std::deque<TVector> m_y; ///< Gradient changes of the preconditioned variant
+
+        // Assembles and factorizes the initial Hessian at x, returns false if the factorization failed
+        bool refresh_preconditioner(Problem &objFunc, const TVector &x);
+
+        // Two-loop recursion computing d = -H g with H₀ applied by the linear solver
+        void apply_preconditioned_inverse(const TVector &grad, TVector &direction);
+
+        double assembly_time;
+        double inverting_time;
     };
 } // namespace polysolve::nonlinear
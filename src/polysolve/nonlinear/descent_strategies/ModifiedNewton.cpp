@@ -0,0 +1,161 @@
+#include "ModifiedNewton.hpp"
+
+#include <polysolve/Utils.hpp>
+
+namespace polysolve::nonlinear
+{
+    ModifiedNewton::ModifiedNewton(const json &solver_params,
+                                   const json &linear_solver_params,
+                                   const double characteristic_length,
+                                   spdlog::logger &logger)
+        : Superclass(solver_params, characteristic_length, logger)
+    {
+        max_lag = extract_param("ModifiedNewton", "max_lag", solver_params);
+        rate_threshold = extract_param("ModifiedNewton", "rate_threshold", solver_params);
+        secant_update = extract_param<bool>("ModifiedNewton", "secant_update", solver_params);
+        project_to_psd = extract_param<bool>("ModifiedNewton", "project_to_psd", solver_params);
+
+        if (max_lag <= 0)
+            log_and_throw_error(logger, "ModifiedNewton max_lag must be > 0, instead got {}", max_lag);
+
+        if (rate_threshold <= 0)
+            log_and_throw_error(logger, "ModifiedNewton rate_threshold must be > 0, instead got {}", rate_threshold);
+
+        linear_solver = polysolve::linear::Solver::create(linear_solver_params, logger);
+        if (linear_solver->is_dense())
+            log_and_throw_error(logger, "ModifiedNewton linear solver must be sparse, instead got {}", linear_solver->name());
+    }
+
+    void ModifiedNewton::reset(const int ndof)
+    {
+        Superclass::reset(ndof);
+        has_factorization = false;
+        lag = 0;
+        is_stale = false;
+        prev_grad_norm = std::nan("");
+        secant_u.clear();
+        secant_s.clear();
+        prev_x.resize(0);
+        n_factorizations = 0;
+        internal_solver_info = json::array();
+    }
+
+    bool ModifiedNewton::handle_error()
+    {
+        if (!is_stale)
+            return false;
+
+        // Retry with the Hessian at the current x
+        has_factorization = false;
+        is_stale = false;
+        return true;
+    }
+
+    bool ModifiedNewton::compute_update_direction(
+        Problem &objFunc,
+        const TVector &x,
+        const TVector &grad,
+        TVector &direction)
+    {
+        const double grad_norm = grad.norm();
+        const bool is_slow = !std::isnan(prev_grad_norm) && grad_norm > rate_threshold * prev_grad_norm;
+
+        if (!has_factorization || lag >= max_lag || is_slow)
+        {
+            if (has_factorization)
+                m_logger.trace("[{}] refreshing the Hessian after {} iterations (‖∇f‖ ratio={:g})",
+                               name(), lag, grad_norm / prev_grad_norm);
+
+            if (!refresh_factorization(objFunc, x))
+                return false;
+        }
+        else if (secant_update && prev_x.size() == x.size() && prev_x != x)
+        {
+            add_secant_update(x - prev_x, grad - prev_grad);
+        }
+
+        is_stale = lag > 0;
+        ++lag;
+
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("linear solve", inverting_time, m_logger);
+            apply_inverse(-grad, direction);
+        }
+
+        prev_grad_norm = grad_norm;
+        if (secant_update)
+        {
+            prev_x = x;
+            prev_grad = grad;
+        }
+
+        json info;
+        linear_solver->get_info(info);
+        info["lag"] = lag - 1;
+        info["secant_updates"] = secant_u.size();
+        internal_solver_info.push_back(info);
+
+        return direction.allFinite();
+    }
+
+    bool ModifiedNewton::refresh_factorization(Problem &objFunc, const TVector &x)
+    {
+        has_factorization = false;
+        lag = 0;
+        secant_u.clear();
+        secant_s.clear();
+
+        polysolve::StiffnessMatrix hessian;
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("assembly time", assembly_time, m_logger);
+            objFunc.set_project_to_psd(project_to_psd);
+            objFunc.compute(x, nullptr, nullptr, &hessian);
+        }
+
+        POLYSOLVE_SCOPED_STOPWATCH("linear solve", inverting_time, m_logger);
+
+        if (!hessian_pattern.factorize(*linear_solver, hessian, m_logger))
+            return false;
+
+        has_factorization = true;
+        ++n_factorizations;
+        return true;
+    }
+
+    void ModifiedNewton::apply_inverse(const TVector &r, TVector &result)
+    {
+        result.setZero(r.size());
+        linear_solver->solve(r, result);
+
+        for (size_t i = 0; i < secant_u.size(); ++i)
+            result += secant_u[i] * secant_s[i].dot(result);
+    }
+
+    void ModifiedNewton::add_secant_update(const TVector &s, const TVector &y)
+    {
+        // "Good" Broyden update of the inverse: H⁻¹ ← H⁻¹ + (s - H⁻¹y) sᵀH⁻¹ / (sᵀH⁻¹y)
+        TVector h;
+        apply_inverse(y, h);
+
+        const double sh = s.dot(h);
+        if (std::abs(sh) <= 1e-12 * s.norm() * h.norm())
+        {
+            m_logger.trace("[{}] skipping degenerate secant update", name());
+            return;
+        }
+
+        secant_u.push_back((s - h) / sh);
+        secant_s.push_back(s);
+    }
+
+    void ModifiedNewton::update_solver_info(json &solver_info, const double per_iteration)
+    {
+        Superclass::update_solver_info(solver_info, per_iteration);
+
+        solver_info["internal_solver"] = internal_solver_info;
+        solver_info["factorizations"] = n_factorizations;
+        solver_info["time_assembly"] = assembly_time / per_iteration;
+        solver_info["time_inverting"] = inverting_time / per_iteration;
+    }
+
+} // namespace polysolve::nonlinear
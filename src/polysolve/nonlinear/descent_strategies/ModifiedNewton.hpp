@@ -0,0 +1,82 @@
+#pragma once
+
+#include "DescentStrategy.hpp"
+#include "SparsityPatternCache.hpp"
+#include <polysolve/Utils.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <vector>
+
+namespace polysolve::nonlinear
+{
+    /// @brief Newton with a lagged Hessian: the factorization is reused for several iterations and
+    /// only refreshed when it gets too old or the convergence rate degrades. Optionally, Broyden
+    /// secant corrections are applied on top of the stale factorization.
+    class ModifiedNewton : public DescentStrategy
+    {
+    public:
+        using Superclass = DescentStrategy;
+
+        ModifiedNewton(const json &solver_params,
+                       const json &linear_solver_params,
+                       const double characteristic_length,
+                       spdlog::logger &logger);
+
+        std::string name() const override { return "ModifiedNewton"; }
+
+        void reset(const int ndof) override;
+        void update_solver_info(json &solver_info, const double per_iteration) override;
+
+        void reset_times() override
+        {
+            assembly_time = 0;
+            inverting_time = 0;
+        }
+
+        // Refreshes the factorization if the failed direction used a stale one
+        bool handle_error() override;
+
+        bool compute_update_direction(
+            Problem &objFunc,
+            const TVector &x,
+            const TVector &grad,
+            TVector &direction) override;
+
+    private:
+        // Assembles and factorizes the Hessian at x, returns false if the factorization failed
+        bool refresh_factorization(Problem &objFunc, const TVector &x);
+
+        // Applies the inverse of the lagged Hessian with its secant corrections to r
+        void apply_inverse(const TVector &r, TVector &result);
+
+        // Broyden update from the step s and the gradient change y
+        void add_secant_update(const TVector &s, const TVector &y);
+
+        int max_lag;           ///< Maximum number of directions computed with one factorization
+        double rate_threshold; ///< Refresh when ‖∇f_k‖ > rate_threshold ‖∇f_{k-1}‖
+        bool secant_update;
+        bool project_to_psd;
+
+        std::unique_ptr<polysolve::linear::Solver> linear_solver; ///< Holds the lagged factorization
+
+        bool has_factorization;
+        int lag;               ///< Number of directions computed with the current factorization
+        bool is_stale;         ///< Whether the last direction used a factorization from a previous x
+        double prev_grad_norm; ///< ‖∇f‖ of the previous direction (nan before the first)
+
+        SparsityPatternCache hessian_pattern;
+
+        // Secant corrections: H⁻¹ r = (I + u_k s_kᵀ) ⋯ (I + u_1 s_1ᵀ) H₀⁻¹ r
+        std::vector<TVector> secant_u;
+        std::vector<TVector> secant_s;
+        TVector prev_x;
+        TVector prev_grad;
+
+        int n_factorizations;
+        json internal_solver_info = json::array();
+
+        double assembly_time;
+        double inverting_time;
+    };
+} // namespace polysolve::nonlinear
@@ -4,6 +4,24 @@
 
 namespace polysolve::nonlinear
 {
+    void Newton::HessianOperator::set(Problem &objFunc_, const TVector &x_)
+    {
+        objFunc = &objFunc_;
+        x = x_;
+        unsupported = false;
+    }
+
+    void Newton::HessianOperator::apply(const Eigen::Ref<const Eigen::VectorXd> v, Eigen::Ref<Eigen::VectorXd> hv) const
+    {
+        assert(objFunc != nullptr);
+        TVector tmp;
+        if (!objFunc->hessian_vector_product(x, v, tmp))
+        {
+            unsupported = true;
+            throw std::runtime_error("the problem does not provide Hessian-vector products");
+        }
+        hv = tmp;
+    }
 
     std::vector<std::shared_ptr<DescentStrategy>> Newton::create_solver(
         const bool sparse,
@@ -15,9 +33,13 @@ namespace polysolve::nonlinear
         // Copies stuff from main newton
         json proj_solver_params = R"({"ProjectedNewton": {}})"_json;
         proj_solver_params["ProjectedNewton"]["residual_tolerance"] = solver_params["Newton"]["residual_tolerance"];
+        proj_solver_params["ProjectedNewton"]["forcing_term"] = solver_params["Newton"]["forcing_term"];
+        proj_solver_params["ProjectedNewton"]["max_forcing_term"] = solver_params["Newton"]["max_forcing_term"];
 
         json reg_solver_params = R"({"RegularizedNewton": {}})"_json;
         reg_solver_params["RegularizedNewton"]["residual_tolerance"] = solver_params["Newton"]["residual_tolerance"];
+        reg_solver_params["RegularizedNewton"]["forcing_term"] = solver_params["Newton"]["forcing_term"];
+        reg_solver_params["RegularizedNewton"]["max_forcing_term"] = solver_params["Newton"]["max_forcing_term"];
         reg_solver_params["RegularizedNewton"]["reg_weight_min"] = solver_params["Newton"]["reg_weight_min"];
         reg_solver_params["RegularizedNewton"]["reg_weight_max"] = solver_params["Newton"]["reg_weight_max"];
         reg_solver_params["RegularizedNewton"]["reg_weight_inc"] = solver_params["Newton"]["reg_weight_inc"];
@@ -52,12 +74,15 @@ namespace polysolve::nonlinear
 
     Newton::Newton(const bool sparse,
                    const double residual_tolerance,
+                   const int forcing_term_choice,
+                   const double max_forcing_term,
                    const json &solver_params,
                    const json &linear_solver_params,
                    const double characteristic_length,
                    spdlog::logger &logger)
         : Superclass(solver_params, characteristic_length, logger),
-          is_sparse(sparse), m_characteristic_length(characteristic_length), m_residual_tolerance(residual_tolerance)
+          is_sparse(sparse), m_characteristic_length(characteristic_length), m_residual_tolerance(residual_tolerance),
+          forcing_term_choice(forcing_term_choice), max_forcing_term(max_forcing_term)
     {
         linear_solver = polysolve::linear::Solver::create(linear_solver_params, logger);
         if (linear_solver->is_dense() == sparse)
@@ -65,6 +90,12 @@ namespace polysolve::nonlinear
 
         if (m_residual_tolerance <= 0)
             log_and_throw_error(logger, "Newton residual_tolerance must be > 0, instead got {}", m_residual_tolerance);
+
+        if (forcing_term_choice < 0 || forcing_term_choice > 2)
+            log_and_throw_error(logger, "Newton forcing_term must be 0, 1, or 2, instead got {}", forcing_term_choice);
+
+        if (max_forcing_term <= 0 || max_forcing_term >= 1)
+            log_and_throw_error(logger, "Newton max_forcing_term must be in (0, 1), instead got {}", max_forcing_term);
     }
 
     Newton::Newton(
@@ -73,8 +104,18 @@ namespace polysolve::nonlinear
         const json &linear_solver_params,
         const double characteristic_length,
         spdlog::logger &logger)
-        : Newton(sparse, extract_param("Newton", "residual_tolerance", solver_params), solver_params, linear_solver_params, characteristic_length, logger)
+        : Newton(sparse, extract_param("Newton", "residual_tolerance", solver_params),
+                 extract_param("Newton", "forcing_term", solver_params), extract_param("Newton", "max_forcing_term", solver_params),
+                 solver_params, linear_solver_params, characteristic_length, logger)
     {
+        // Only the unmodified Hessian can be applied without assembling it
+        matrix_free = solver_params.contains("Newton") ? solver_params["Newton"]["matrix_free"] : solver_params["matrix_free"];
+
+        if (matrix_free && !sparse)
+            log_and_throw_error(logger, "Newton matrix_free is only available for sparse Newton");
+
+        if (matrix_free && !linear_solver->supports_matrix_free())
+            log_and_throw_error(logger, "Newton matrix_free needs a matrix-free linear solver, instead got {}", linear_solver->name());
     }
 
     ProjectedNewton::ProjectedNewton(
@@ -83,7 +124,9 @@ namespace polysolve::nonlinear
         const json &linear_solver_params,
         const double characteristic_length,
         spdlog::logger &logger)
-        : Superclass(sparse, extract_param("ProjectedNewton", "residual_tolerance", solver_params), solver_params, linear_solver_params, characteristic_length, logger)
+        : Superclass(sparse, extract_param("ProjectedNewton", "residual_tolerance", solver_params),
+                     extract_param("ProjectedNewton", "forcing_term", solver_params), extract_param("ProjectedNewton", "max_forcing_term", solver_params),
+                     solver_params, linear_solver_params, characteristic_length, logger)
     {
     }
 
@@ -94,7 +137,9 @@ namespace polysolve::nonlinear
         const json &linear_solver_params,
         const double characteristic_length,
         spdlog::logger &logger)
-        : Superclass(sparse, extract_param("RegularizedNewton", "residual_tolerance", solver_params), solver_params, linear_solver_params, characteristic_length, logger),
+        : Superclass(sparse, extract_param("RegularizedNewton", "residual_tolerance", solver_params),
+                     extract_param("RegularizedNewton", "forcing_term", solver_params), extract_param("RegularizedNewton", "max_forcing_term", solver_params),
+                     solver_params, linear_solver_params, characteristic_length, logger),
           project_to_psd(project_to_psd)
     {
         reg_weight_min = extract_param("RegularizedNewton", "reg_weight_min", solver_params);
@@ -119,12 +164,17 @@ namespace polysolve::nonlinear
     {
         Superclass::reset(ndof);
         internal_solver_info = json::array();
+        forcing_term = std::min(0.5, max_forcing_term);
+        last_grad_norm = std::nan("");
+        last_residual = std::nan("");
+        has_hessian_vector_product = true;
     }
 
     void RegularizedNewton::reset(const int ndof)
     {
         Superclass::reset(ndof);
         reg_weight = reg_weight_min;
+        is_retry = false;
     }
 
     // =======================================================================
@@ -135,15 +185,31 @@ namespace polysolve::nonlinear
         const TVector &grad,
         TVector &direction)
     {
+        const double grad_norm = grad.norm();
+        double residual_tolerance = m_residual_tolerance * m_characteristic_length;
+        if (forcing_term_choice > 0)
+        {
+            update_forcing_term(grad_norm);
+            linear_solver->set_tolerance(forcing_term);
+            // The direction is only as accurate as the forcing term asks for, with some slack for the
+            // difference between the residual estimated by the linear solver and the true one
+            constexpr double slack = 2;
+            residual_tolerance = std::max(residual_tolerance, slack * forcing_term * grad_norm);
+            m_logger.trace("[{}] forcing term {:g}", name(), forcing_term);
+        }
+
         const double residual =
             is_sparse ? //
                 solve_sparse_linear_system(objFunc, x, grad, direction)
                       : solve_dense_linear_system(objFunc, x, grad, direction);
 
-        if (std::isnan(residual) || residual > m_residual_tolerance * m_characteristic_length)
+        last_grad_norm = grad_norm;
+        last_residual = residual;
+
+        if (std::isnan(residual) || residual > residual_tolerance)
         {
             m_logger.debug("[{}] large (or nan) linear solve residual {}>{} (||∇f||={})",
-                           name(), residual, m_residual_tolerance * m_characteristic_length, grad.norm());
+                           name(), residual, residual_tolerance, grad_norm);
 
             return false;
         }
@@ -157,6 +223,33 @@ namespace polysolve::nonlinear
 
     // =======================================================================
 
+    void Newton::update_forcing_term(const double grad_norm)
+    {
+        // Eisenstat and Walker [1996], "Choosing the forcing terms in an inexact Newton method"
+        if (std::isnan(last_grad_norm) || std::isnan(last_residual) || last_grad_norm == 0)
+            return; // keep the initial forcing term
+
+        double eta, safeguard;
+        if (forcing_term_choice == 1)
+        {
+            eta = std::abs(grad_norm - last_residual) / last_grad_norm;
+            safeguard = std::pow(forcing_term, (1 + std::sqrt(5.0)) / 2);
+        }
+        else
+        {
+            constexpr double gamma = 0.9;
+            constexpr double alpha = 2;
+            eta = gamma * std::pow(grad_norm / last_grad_norm, alpha);
+            safeguard = gamma * std::pow(forcing_term, alpha);
+        }
+
+        // Prevent the forcing term from decreasing too fast far from the solution
+        if (safeguard > 0.1)
+            eta = std::max(eta, safeguard);
+
+        forcing_term = std::min(eta, max_forcing_term);
+    }
+
     // =======================================================================
 
     double Newton::solve_sparse_linear_system(Problem &objFunc,
@@ -164,25 +257,40 @@ namespace polysolve::nonlinear
                                               const TVector &grad,
                                               TVector &direction)
     {
-        polysolve::StiffnessMatrix hessian;
+        if (matrix_free && has_hessian_vector_product)
+        {
+            const double residual = solve_matrix_free_linear_system(objFunc, x, grad, direction);
+            if (has_hessian_vector_product)
+                return residual;
+            m_logger.debug("[{}] the problem does not provide Hessian-vector products, assembling the Hessian", name());
+        }
+
+        polysolve::StiffnessMatrix &hessian = sparse_hessian;
 
         {
             POLYSOLVE_SCOPED_STOPWATCH("assembly time", this->assembly_time, m_logger);
             compute_hessian(objFunc, x, hessian);
         }
 
+        const double shift = hessian_shift();
+        bool is_shifted_by_solver = false;
+
         {
             POLYSOLVE_SCOPED_STOPWATCH("linear solve", this->inverting_time, m_logger);
             // TODO: get the correct size
-            {
-                double analyze_time;
-                POLYSOLVE_SCOPED_STOPWATCH("analyze pattern", analyze_time, m_logger);
-                linear_solver->analyze_pattern(hessian, hessian.rows());
-            }
+            hessian_pattern.analyze_pattern(*linear_solver, hessian, m_logger);
 
             try
             {
-                linear_solver->factorize(hessian);
+                if (shift != 0)
+                    is_shifted_by_solver = linear_solver->refactorize_shifted(hessian, shift);
+
+                if (!is_shifted_by_solver)
+                {
+                    if (shift != 0)
+                        shift_hessian(hessian, shift);
+                    linear_solver->factorize(hessian);
+                }
             }
             catch (const std::runtime_error &err)
             {
@@ -196,10 +304,52 @@ namespace polysolve::nonlinear
             linear_solver->solve(-grad, direction); // H Δx = -g
         }
 
-        const double residual = (hessian * direction + grad).norm(); // H Δx + g = 0
+        TVector residual_vector = hessian * direction + grad; // H Δx + g = 0
+        if (is_shifted_by_solver)
+            residual_vector += shift * direction;
+        const double residual = residual_vector.norm();
 
         json info;
         linear_solver->get_info(info);
+        if (forcing_term_choice > 0)
+            info["forcing_term"] = forcing_term;
+        internal_solver_info.push_back(info);
+
+        return residual;
+    }
+
+    double Newton::solve_matrix_free_linear_system(Problem &objFunc,
+                                                   const TVector &x,
+                                                   const TVector &grad,
+                                                   TVector &direction)
+    {
+        HessianOperator &hessian = hessian_operator;
+        hessian.set(objFunc, x);
+        TVector hessian_direction(x.size());
+
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("linear solve", this->inverting_time, m_logger);
+
+            try
+            {
+                linear_solver->factorize_operator(hessian);
+                linear_solver->solve(-grad, direction); // H Δx = -g
+                hessian.apply(direction, hessian_direction);
+            }
+            catch (const std::runtime_error &err)
+            {
+                has_hessian_vector_product = !hessian.unsupported;
+                m_logger.debug("Unable to solve with the Hessian operator: \"{}\"", err.what());
+                return std::nan("");
+            }
+        }
+
+        const double residual = (hessian_direction + grad).norm(); // H Δx + g = 0
+
+        json info;
+        linear_solver->get_info(info);
+        if (forcing_term_choice > 0)
+            info["forcing_term"] = forcing_term;
         internal_solver_info.push_back(info);
 
         return residual;
@@ -240,6 +390,8 @@ namespace polysolve::nonlinear
 
         json info;
         linear_solver->get_info(info);
+        if (forcing_term_choice > 0)
+            info["forcing_term"] = forcing_term;
         internal_solver_info.push_back(info);
 
         return residual;
@@ -252,7 +404,7 @@ namespace polysolve::nonlinear
 
     {
         objFunc.set_project_to_psd(false);
-        objFunc.hessian(x, hessian);
+        objFunc.compute(x, nullptr, nullptr, &hessian);
     }
 
     void ProjectedNewton::compute_hessian(Problem &objFunc,
@@ -261,7 +413,7 @@ namespace polysolve::nonlinear
 
     {
         objFunc.set_project_to_psd(true);
-        objFunc.hessian(x, hessian);
+        objFunc.compute(x, nullptr, nullptr, &hessian);
     }
 
     void RegularizedNewton::compute_hessian(Problem &objFunc,
@@ -269,17 +421,56 @@ namespace polysolve::nonlinear
                                             polysolve::StiffnessMatrix &hessian)
 
     {
-        if (x.size() != x_cache.size() || x != x_cache)
+        // On retries, x is unchanged and hessian still holds the Hessian, possibly shifted by shift_hessian
+        if (!is_retry || hessian_diagonal.size() != x.size())
         {
             objFunc.set_project_to_psd(project_to_psd);
-            objFunc.hessian(x, hessian_cache);
-            x_cache = x;
+            objFunc.compute(x, nullptr, nullptr, &hessian);
+            cache_diagonal(hessian);
         }
-        hessian = hessian_cache;
-        if (reg_weight > 0)
+        else
         {
-            hessian += reg_weight * sparse_identity(hessian.rows(), hessian.cols());
+            shift_hessian(hessian, 0);
         }
+        is_retry = false;
+    }
+
+    void RegularizedNewton::shift_hessian(polysolve::StiffnessMatrix &hessian, const double shift)
+    {
+        // In place, the diagonal entries are always stored
+        for (Eigen::Index k = 0; k < hessian.cols(); ++k)
+            hessian.valuePtr()[diagonal_index[k]] = hessian_diagonal[k] + shift;
+    }
+
+    void RegularizedNewton::cache_diagonal(polysolve::StiffnessMatrix &hessian)
+    {
+        const auto find_diagonal = [&]() {
+            for (Eigen::Index k = 0; k < hessian.outerSize(); ++k)
+            {
+                const auto *begin = hessian.innerIndexPtr() + hessian.outerIndexPtr()[k];
+                const auto *end = hessian.innerIndexPtr() + hessian.outerIndexPtr()[k + 1];
+                const auto *it = std::lower_bound(begin, end, k);
+                if (it == end || *it != k)
+                    return false;
+                diagonal_index[k] = it - hessian.innerIndexPtr();
+            }
+            return true;
+        };
+
+        hessian.makeCompressed();
+        diagonal_index.resize(hessian.cols());
+        if (!find_diagonal())
+        {
+            // Store the missing diagonal entries, so that the shift does not change the pattern
+            hessian += 0 * sparse_identity(hessian.rows(), hessian.cols());
+            hessian.makeCompressed();
+            [[maybe_unused]] const bool has_diagonal = find_diagonal();
+            assert(has_diagonal);
+        }
+
+        hessian_diagonal.resize(hessian.cols());
+        for (Eigen::Index k = 0; k < hessian.cols(); ++k)
+            hessian_diagonal[k] = hessian.valuePtr()[diagonal_index[k]];
     }
 
     void Newton::compute_hessian(Problem &objFunc,
@@ -318,7 +509,8 @@ namespace polysolve::nonlinear
     bool RegularizedNewton::handle_error()
     {
         reg_weight *= reg_weight_inc;
-        return reg_weight < reg_weight_max;
+        is_retry = reg_weight < reg_weight_max;
+        return is_retry;
     }
     // =======================================================================
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DescentStrategy.hpp"
+#include "SparsityPatternCache.hpp"
 #include <polysolve/Utils.hpp>
 
 #include <polysolve/linear/Solver.hpp>
@@ -22,6 +23,8 @@ namespace polysolve::nonlinear
     protected:
         Newton(const bool sparse,
                const double residual_tolerance,
+               const int forcing_term_choice,
+               const double max_forcing_term,
                const json &solver_params,
                const json &linear_solver_params,
                const double characteristic_length,
@@ -43,6 +46,13 @@ namespace polysolve::nonlinear
         double solve_dense_linear_system(Problem &objFunc,
                                          const TVector &x, const TVector &grad,
                                          TVector &direction);
+        // Solves with the Hessian-vector product of the problem, returns nan if it has none
+        double solve_matrix_free_linear_system(Problem &objFunc,
+                                               const TVector &x, const TVector &grad,
+                                               TVector &direction);
+
+        // Eisenstat–Walker forcing term of the inexact Newton mode
+        void update_forcing_term(const double grad_norm);
 
         json internal_solver_info = json::array();
 
@@ -50,8 +60,42 @@ namespace polysolve::nonlinear
         const double m_characteristic_length;
         double m_residual_tolerance;
 
+        int forcing_term_choice; ///< Eisenstat–Walker choice (1 or 2), 0 for exact Newton
+        double max_forcing_term;
+        double forcing_term;     ///< Relative tolerance of the current linear solve
+        double last_grad_norm;   ///< ‖∇f‖ at the previous linear solve (nan before the first)
+        double last_residual;    ///< ‖H Δx + ∇f‖ of the previous linear solve
+
+        // Hessian of the problem at x, applied through its Hessian-vector product
+        class HessianOperator : public polysolve::linear::LinearOperator
+        {
+        public:
+            void set(Problem &objFunc, const TVector &x);
+
+            int rows() const override { return x.size(); }
+            void apply(const Eigen::Ref<const Eigen::VectorXd> v, Eigen::Ref<Eigen::VectorXd> hv) const override;
+
+            mutable bool unsupported = false;
+
+        private:
+            Problem *objFunc = nullptr;
+            TVector x;
+        };
+
+        /// Operator of the last matrix-free solve, the linear solver keeps a pointer to it after factorize_operator
+        /// (declared before linear_solver so that it outlives it)
+        HessianOperator hessian_operator;
+
         std::unique_ptr<polysolve::linear::Solver> linear_solver; ///< Linear solver used to solve the linear system
 
+        /// Sparse Hessian of the last linear solve, kept between calls so that it can be updated in place
+        polysolve::StiffnessMatrix sparse_hessian;
+
+        bool matrix_free = false;        ///< Use Hessian-vector products instead of the assembled Hessian
+        bool has_hessian_vector_product; ///< Whether the problem provided Hessian-vector products so far
+
+        SparsityPatternCache hessian_pattern; ///< Skips the symbolic analysis while the pattern is unchanged
+
         double assembly_time;
         double inverting_time;
 
@@ -66,6 +110,11 @@ namespace polysolve::nonlinear
                                      const TVector &x,
                                      Eigen::MatrixXd &hessian);
 
+        // Diagonal shift σ of the sparse system (H + σI) Δx = -g, applied by the linear solver if it
+        // supports it (e.g., Cholmod), otherwise by shift_hessian before factorizing
+        virtual double hessian_shift() const { return 0; }
+        virtual void shift_hessian(polysolve::StiffnessMatrix &hessian, const double shift) {}
+
     public:
         bool compute_update_direction(Problem &objFunc, const TVector &x, const TVector &grad, TVector &direction) override;
 
@@ -127,8 +176,12 @@ namespace polysolve::nonlinear
         double reg_weight_max;
         double reg_weight_inc;
 
-        TVector x_cache;
-        polysolve::StiffnessMatrix hessian_cache;
+        bool is_retry = false;                    ///< Whether the next direction is at the same x (after handle_error)
+        std::vector<Eigen::Index> diagonal_index; ///< Position of the diagonal entries in the Hessian values
+        TVector hessian_diagonal;                 ///< Diagonal of the Hessian before regularization
+
+        // Stores the diagonal of the (compressed) Hessian and its position, adding missing entries
+        void cache_diagonal(polysolve::StiffnessMatrix &hessian);
 
         double reg_weight; ///< Regularization Coefficients
     protected:
@@ -139,6 +192,9 @@ namespace polysolve::nonlinear
         void compute_hessian(Problem &objFunc,
                              const TVector &x,
                              Eigen::MatrixXd &hessian) override;
+
+        double hessian_shift() const override { return reg_weight; }
+        void shift_hessian(polysolve::StiffnessMatrix &hessian, const double shift) override;
     };
 
 } // namespace polysolve::nonlinear
@@ -0,0 +1,38 @@
+#include "SparsityPatternCache.hpp"
+
+#include <polysolve/Utils.hpp>
+
+namespace polysolve::nonlinear
+{
+    void SparsityPatternCache::analyze_pattern(polysolve::linear::Solver &solver, const StiffnessMatrix &A, spdlog::logger &logger)
+    {
+        const size_t hash = sparsity_pattern_hash(A);
+        if (has_analyzed_pattern && hash == pattern_hash)
+        {
+            logger.trace("Hessian sparsity pattern unchanged; skipping analyze pattern");
+            return;
+        }
+
+        double analyze_time;
+        POLYSOLVE_SCOPED_STOPWATCH("analyze pattern", analyze_time, logger);
+        solver.analyze_pattern(A, A.rows());
+        pattern_hash = hash;
+        has_analyzed_pattern = true;
+    }
+
+    bool SparsityPatternCache::factorize(polysolve::linear::Solver &solver, const StiffnessMatrix &A, spdlog::logger &logger)
+    {
+        analyze_pattern(solver, A, logger);
+
+        try
+        {
+            solver.factorize(A);
+        }
+        catch (const std::runtime_error &err)
+        {
+            logger.debug("Unable to factorize Hessian: \"{}\"", err.what());
+            return false;
+        }
+        return true;
+    }
+} // namespace polysolve::nonlinear
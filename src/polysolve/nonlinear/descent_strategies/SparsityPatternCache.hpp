@@ -0,0 +1,26 @@
+#pragma once
+
+#include <polysolve/Types.hpp>
+
+#include <polysolve/linear/Solver.hpp>
+
+#include <spdlog/spdlog.h>
+
+namespace polysolve::nonlinear
+{
+    /// Redoes the symbolic analysis (e.g., reordering) of a sparse linear solver only when the
+    /// sparsity pattern of the matrix changes, as Hessians often keep theirs between iterations.
+    class SparsityPatternCache
+    {
+    public:
+        /// Calls analyze_pattern on the solver if the pattern of A differs from the last analyzed one
+        void analyze_pattern(polysolve::linear::Solver &solver, const StiffnessMatrix &A, spdlog::logger &logger);
+
+        /// analyze_pattern, then factorize A, returns false if the factorization failed
+        bool factorize(polysolve::linear::Solver &solver, const StiffnessMatrix &A, spdlog::logger &logger);
+
+    private:
+        bool has_analyzed_pattern = false; ///< Whether analyze_pattern has been called on the linear solver
+        size_t pattern_hash;               ///< Fingerprint of the last analyzed sparsity pattern
+    };
+} // namespace polysolve::nonlinear
@@ -0,0 +1,195 @@
+#include "TrustRegionNewtonCG.hpp"
+
+#include <polysolve/Utils.hpp>
+
+namespace polysolve::nonlinear
+{
+    namespace
+    {
+        // Largest τ ≥ 0 such that ‖p + τ d‖ = radius, for ‖p‖ ≤ radius; 0 if d = 0 (e.g., a zero gradient)
+        double step_to_boundary(const Problem::TVector &p, const Problem::TVector &d, const double radius)
+        {
+            const double a = d.squaredNorm();
+            if (a == 0)
+                return 0;
+            const double b = 2 * p.dot(d);
+            const double c = p.squaredNorm() - radius * radius;
+            return (-b + std::sqrt(std::max(b * b - 4 * a * c, 0.0))) / (2 * a);
+        }
+    } // namespace
+
+    TrustRegionNewtonCG::TrustRegionNewtonCG(const json &solver_params,
+                                             const double characteristic_length,
+                                             spdlog::logger &logger)
+        : Superclass(solver_params, characteristic_length, logger)
+    {
+        initial_radius = extract_param("TrustRegionNewtonCG", "initial_radius", solver_params);
+        max_radius = extract_param("TrustRegionNewtonCG", "max_radius", solver_params);
+        max_cg_iterations = extract_param("TrustRegionNewtonCG", "max_cg_iterations", solver_params);
+
+        if (initial_radius <= 0)
+            log_and_throw_error(logger, "TrustRegionNewtonCG initial_radius must be > 0, instead got {}", initial_radius);
+
+        if (max_radius < initial_radius)
+            log_and_throw_error(logger, "TrustRegionNewtonCG max_radius must be >= {}, instead got {}", initial_radius, max_radius);
+
+        if (max_cg_iterations <= 0)
+            log_and_throw_error(logger, "TrustRegionNewtonCG max_cg_iterations must be > 0, instead got {}", max_cg_iterations);
+
+        // The radii are relative to the size of the problem
+        initial_radius *= characteristic_length;
+        max_radius *= characteristic_length;
+        min_radius = 1e-8 * initial_radius;
+    }
+
+    void TrustRegionNewtonCG::reset(const int ndof)
+    {
+        Superclass::reset(ndof);
+        radius = initial_radius;
+        use_assembled_hessian = false;
+        prev_x.resize(0);
+        cg_info = json::array();
+    }
+
+    bool TrustRegionNewtonCG::handle_error()
+    {
+        radius *= 0.25;
+        return radius > min_radius;
+    }
+
+    bool TrustRegionNewtonCG::compute_update_direction(
+        Problem &objFunc,
+        const TVector &x,
+        const TVector &grad,
+        TVector &direction)
+    {
+        const bool same_x = prev_x.size() == x.size() && prev_x == x;
+        if (!same_x)
+        {
+            update_radius(x, grad);
+            use_assembled_hessian = false; // the Hessian of a previous x is outdated
+        }
+
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("truncated CG", cg_time, m_logger);
+            steihaug_cg(objFunc, x, grad, direction);
+        }
+
+        cg_info.push_back({{"cg_iterations", cg_iterations},
+                           {"termination", cg_termination},
+                           {"radius", radius}});
+        m_logger.trace("[{}] CG {} after {} iterations (radius={:g})", name(), cg_termination, cg_iterations, radius);
+
+        prev_x = x;
+        prev_grad = grad;
+        prev_direction = direction;
+
+        return direction.allFinite();
+    }
+
+    void TrustRegionNewtonCG::update_radius(const TVector &x, const TVector &grad)
+    {
+        if (prev_x.size() != x.size() || prev_direction.squaredNorm() == 0)
+            return;
+
+        // The line search may have scaled the direction
+        const TVector s = x - prev_x;
+        const double alpha = s.dot(prev_direction) / prev_direction.squaredNorm();
+
+        const double predicted = -(alpha * prev_grad.dot(prev_direction) + 0.5 * alpha * alpha * prev_curvature);
+        // f(prev_x) - f(x) ≈ -½ sᵀ(∇f(prev_x) + ∇f(x)) is exact for quadratics and avoids evaluating f
+        const double actual = -0.5 * s.dot(prev_grad + grad);
+        const double rho = predicted > 0 ? (actual / predicted) : 0;
+
+        const double step_norm = s.norm();
+        if (rho < 0.25)
+            radius = std::max(0.25 * radius, min_radius);
+        else if (rho > 0.75 && step_norm >= 0.99 * radius)
+            radius = std::min(2 * radius, max_radius);
+    }
+
+    void TrustRegionNewtonCG::hessian_vector_product(Problem &objFunc, const TVector &x, const TVector &v, TVector &hv)
+    {
+        if (!use_assembled_hessian && objFunc.hessian_vector_product(x, v, hv))
+            return;
+
+        if (!use_assembled_hessian)
+        {
+            POLYSOLVE_SCOPED_STOPWATCH("assembly time", assembly_time, m_logger);
+            objFunc.set_project_to_psd(false);
+            objFunc.compute(x, nullptr, nullptr, &hessian);
+            use_assembled_hessian = true;
+        }
+
+        hv = hessian * v;
+    }
+
+    void TrustRegionNewtonCG::steihaug_cg(Problem &objFunc, const TVector &x, const TVector &grad, TVector &direction)
+    {
+        // Minimizes gᵀp + ½ pᵀHp for ‖p‖ ≤ radius, see Nocedal and Wright, Algorithm 7.2
+        const double grad_norm = grad.norm();
+        const double tolerance = std::min(0.5, std::sqrt(grad_norm)) * grad_norm;
+
+        direction.setZero(grad.size());
+        prev_curvature = 0; // pᵀHp, accumulated using the H-conjugacy of the search directions
+
+        TVector r = grad;
+        TVector d = -r;
+        TVector Hd;
+        double rr = r.squaredNorm();
+
+        cg_termination = "max iterations";
+        for (cg_iterations = 0; cg_iterations < max_cg_iterations; ++cg_iterations)
+        {
+            hessian_vector_product(objFunc, x, d, Hd);
+            const double dHd = d.dot(Hd);
+
+            if (dHd <= 0)
+            {
+                // Negative curvature: go to the boundary along d
+                const double tau = step_to_boundary(direction, d, radius);
+                direction += tau * d;
+                prev_curvature += tau * tau * dHd;
+                cg_termination = "negative curvature";
+                ++cg_iterations;
+                return;
+            }
+
+            const double alpha = rr / dHd;
+            if ((direction + alpha * d).norm() >= radius)
+            {
+                const double tau = step_to_boundary(direction, d, radius);
+                direction += tau * d;
+                prev_curvature += tau * tau * dHd;
+                cg_termination = "trust region boundary";
+                ++cg_iterations;
+                return;
+            }
+
+            direction += alpha * d;
+            prev_curvature += alpha * alpha * dHd;
+            r += alpha * Hd;
+
+            const double rr_next = r.squaredNorm();
+            if (std::sqrt(rr_next) < tolerance)
+            {
+                cg_termination = "converged";
+                ++cg_iterations;
+                return;
+            }
+
+            d = -r + (rr_next / rr) * d;
+            rr = rr_next;
+        }
+    }
+
+    void TrustRegionNewtonCG::update_solver_info(json &solver_info, const double per_iteration)
+    {
+        Superclass::update_solver_info(solver_info, per_iteration);
+
+        solver_info["internal_solver"] = cg_info;
+        solver_info["time_assembly"] = assembly_time / per_iteration;
+        solver_info["time_inverting"] = cg_time / per_iteration;
+    }
+
+} // namespace polysolve::nonlinear
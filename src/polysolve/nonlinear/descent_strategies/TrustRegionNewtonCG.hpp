@@ -0,0 +1,73 @@
+#pragma once
+
+#include "DescentStrategy.hpp"
+#include <polysolve/Utils.hpp>
+
+namespace polysolve::nonlinear
+{
+    /// @brief Trust-region Newton with a truncated (Steihaug) conjugate gradient inner solver.
+    /// Only uses Hessian-vector products, so indefinite Hessians need neither projection nor factorization.
+    class TrustRegionNewtonCG : public DescentStrategy
+    {
+    public:
+        using Superclass = DescentStrategy;
+
+        TrustRegionNewtonCG(const json &solver_params,
+                            const double characteristic_length,
+                            spdlog::logger &logger);
+
+        std::string name() const override { return "TrustRegionNewtonCG"; }
+
+        void reset(const int ndof) override;
+        void update_solver_info(json &solver_info, const double per_iteration) override;
+
+        void reset_times() override
+        {
+            assembly_time = 0;
+            cg_time = 0;
+        }
+
+        // Shrinks the trust region, the direction is retried while the radius is above its minimum
+        bool handle_error() override;
+
+        bool compute_update_direction(
+            Problem &objFunc,
+            const TVector &x,
+            const TVector &grad,
+            TVector &direction) override;
+
+    private:
+        // Updates the radius from the agreement between the model and the step taken since the last call
+        void update_radius(const TVector &x, const TVector &grad);
+
+        // Hessian-vector product, using the assembled Hessian if the problem does not provide one
+        void hessian_vector_product(Problem &objFunc, const TVector &x, const TVector &v, TVector &hv);
+
+        // Approximately minimizes the quadratic model within the trust region (Steihaug–Toint CG)
+        void steihaug_cg(Problem &objFunc, const TVector &x, const TVector &grad, TVector &direction);
+
+        double initial_radius;
+        double max_radius;
+        double min_radius;
+        int max_cg_iterations;
+
+        double radius;
+
+        // Assembled Hessian used when the problem has no Hessian-vector product
+        bool use_assembled_hessian;
+        polysolve::StiffnessMatrix hessian;
+
+        // Model of the previous direction, to measure its agreement with the step taken
+        TVector prev_x;
+        TVector prev_grad;
+        TVector prev_direction;
+        double prev_curvature; ///< Δxᵀ H Δx of the previous direction
+
+        int cg_iterations;
+        std::string cg_termination;
+        json cg_info = json::array();
+
+        double assembly_time;
+        double cg_time;
+    };
+} // namespace polysolve::nonlinear
@@ -26,6 +26,7 @@ namespace polysolve::nonlinear::line_search
         const TVector &old_grad,
         const TVector &new_x,
         const double new_energy,
+        const TVector &new_grad,
         const double step_size) const
     {
         return new_energy <= old_energy + step_size * armijo_criteria;
@@ -20,6 +20,8 @@ namespace polysolve::nonlinear::line_search
             const TVector &delta_x,
             const TVector &old_grad) override;
 
+        bool criteria_needs_gradient(const bool use_grad_norm) const override { return false; }
+
         virtual bool criteria(
             const TVector &delta_x,
             Problem &objFunc,
@@ -28,6 +30,7 @@ namespace polysolve::nonlinear::line_search
             const TVector &old_grad,
             const TVector &new_x,
             const double new_energy,
+            const TVector &new_grad,
             const double step_size) const override;
 
         double c;
@@ -4,6 +4,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <exception>
+
 namespace polysolve::nonlinear::line_search
 {
 
@@ -25,8 +27,14 @@ namespace polysolve::nonlinear::line_search
 
         init_compute_descent_step_size(delta_x, old_grad);
 
-        for (; step_size > current_min_step_size() && cur_iter < current_max_step_size_iter(); step_size *= step_ratio, ++cur_iter)
+        if (use_parallel_trials(objFunc) && uses_fixed_step_ratio())
+            return compute_descent_step_size_in_batches(x, delta_x, objFunc, use_grad_norm, old_energy, old_grad, step_size);
+
+        double new_energy;
+        for (; step_size > current_min_step_size() && cur_iter < current_max_step_size_iter();
+             step_size = next_step_size(old_energy, step_size, new_energy), ++cur_iter)
         {
+            new_energy = std::numeric_limits<double>::quiet_NaN();
             const TVector new_x = x + step_size * delta_x;
 
             try
@@ -45,7 +53,11 @@ namespace polysolve::nonlinear::line_search
                 continue;
             }
 
-            const double new_energy = objFunc.value(new_x);
+            TVector new_grad;
+            if (criteria_needs_gradient(use_grad_norm))
+                objFunc.compute(new_x, &new_energy, &new_grad, nullptr);
+            else
+                new_energy = objFunc.value(new_x);
 
             if (!std::isfinite(new_energy))
             {
@@ -54,7 +66,7 @@ namespace polysolve::nonlinear::line_search
 
             m_logger.trace("ls it: {} ΔE: {}", cur_iter, new_energy - old_energy);
 
-            if (criteria(delta_x, objFunc, use_grad_norm, old_energy, old_grad, new_x, new_energy, step_size))
+            if (criteria(delta_x, objFunc, use_grad_norm, old_energy, old_grad, new_x, new_energy, new_grad, step_size))
             {
                 break; // found a good step size
             }
@@ -63,6 +75,103 @@ namespace polysolve::nonlinear::line_search
         return step_size;
     }
 
+    double Backtracking::compute_descent_step_size_in_batches(
+        const TVector &x,
+        const TVector &delta_x,
+        Problem &objFunc,
+        const bool use_grad_norm,
+        const double old_energy,
+        const TVector &old_grad,
+        const double starting_step_size)
+    {
+        const bool needs_gradient = criteria_needs_gradient(use_grad_norm);
+
+        double step_size = starting_step_size;
+        std::vector<double> step_sizes;
+        std::vector<double> new_energies;
+        std::vector<TVector> new_grads;
+        std::vector<std::exception_ptr> errors;
+        std::vector<std::string> failures;
+
+        while (step_size > current_min_step_size() && cur_iter < current_max_step_size_iter())
+        {
+            trial_step_sizes(step_size, step_ratio, step_sizes);
+            const int n = step_sizes.size();
+            new_energies.assign(n, std::numeric_limits<double>::quiet_NaN());
+            new_grads.assign(n, TVector());
+            errors.assign(n, nullptr);
+            failures.assign(n, "");
+
+            // Each trial uses the state of its own thread, updated as solution_changed would be
+            parallel_for(n, [&](const int i) {
+                try
+                {
+                    const TVector new_x = x + step_sizes[i] * delta_x;
+                    try
+                    {
+                        objFunc.trial_solution_changed(new_x, i);
+                    }
+                    catch (const std::runtime_error &e)
+                    {
+                        failures[i] = e.what();
+                        return;
+                    }
+
+                    if (!objFunc.is_step_valid(x, new_x))
+                        return;
+
+                    if (needs_gradient)
+                        objFunc.compute(new_x, &new_energies[i], &new_grads[i], nullptr);
+                    else
+                        new_energies[i] = objFunc.value(new_x);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+
+            // Accept the largest step satisfying the criteria, as the serial search would
+            for (int i = 0; i < n; ++i, ++cur_iter)
+            {
+                step_size = step_sizes[i];
+                if (errors[i])
+                    std::rethrow_exception(errors[i]);
+
+                if (!failures[i].empty())
+                {
+                    m_logger.warn("Failed to take step due to \"{}\", reduce step size...", failures[i]);
+                    continue;
+                }
+
+                if (!std::isfinite(new_energies[i]))
+                    continue;
+
+                // The criteria are evaluated with the problem state at new_x
+                const TVector new_x = x + step_size * delta_x;
+                try
+                {
+                    POLYSOLVE_SCOPED_STOPWATCH("solution changed - constraint set update in LS", constraint_set_update_time, m_logger);
+                    objFunc.solution_changed(new_x);
+                }
+                catch (const std::runtime_error &e)
+                {
+                    m_logger.warn("Failed to take step due to \"{}\", reduce step size...", e.what());
+                    continue;
+                }
+
+                m_logger.trace("ls it: {} ΔE: {}", cur_iter, new_energies[i] - old_energy);
+
+                if (criteria(delta_x, objFunc, use_grad_norm, old_energy, old_grad, new_x, new_energies[i], new_grads[i], step_size))
+                    return step_size; // found a good step size
+            }
+
+            step_size *= step_ratio;
+        }
+
+        return step_size;
+    }
+
     bool Backtracking::criteria(
         const TVector &delta_x,
         Problem &objFunc,
@@ -71,13 +180,12 @@ namespace polysolve::nonlinear::line_search
         const TVector &old_grad,
         const TVector &new_x,
         const double new_energy,
+        const TVector &new_grad,
         const double step_size) const
     {
         bool flag = false;
         if (use_grad_norm)
         {
-            TVector new_grad;
-            objFunc.gradient(new_x, new_grad);
             if (use_directional_derivative)
                 flag = flag || new_grad.dot(delta_x) <= 0;
             else
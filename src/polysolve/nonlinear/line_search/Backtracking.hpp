@@ -29,6 +29,22 @@ namespace polysolve::nonlinear::line_search
             const TVector &delta_x,
             const TVector &old_grad) {}
 
+        // Next trial step size after step_size was rejected, new_energy is nan if it could not be evaluated
+        virtual double next_step_size(
+            const double old_energy,
+            const double step_size,
+            const double new_energy)
+        {
+            return step_size * step_ratio;
+        }
+
+        // Whether next_step_size always scales the step by step_ratio, so that trial steps can be batched
+        virtual bool uses_fixed_step_ratio() const { return true; }
+
+        // Whether criteria uses the gradient at the new point, which is then evaluated with the energy
+        virtual bool criteria_needs_gradient(const bool use_grad_norm) const { return use_grad_norm; }
+
+        // new_grad is the gradient at new_x if criteria_needs_gradient, empty otherwise
         virtual bool criteria(
             const TVector &delta_x,
             Problem &objFunc,
@@ -37,6 +53,18 @@ namespace polysolve::nonlinear::line_search
             const TVector &old_grad,
             const TVector &new_x,
             const double new_energy,
+            const TVector &new_grad,
             const double step_size) const;
+
+    private:
+        // Same as compute_descent_step_size, evaluating parallel_trials steps at a time
+        double compute_descent_step_size_in_batches(
+            const TVector &x,
+            const TVector &delta_x,
+            Problem &objFunc,
+            const bool use_grad_norm,
+            const double old_energy,
+            const TVector &old_grad,
+            const double starting_step_size);
     };
 } // namespace polysolve::nonlinear::line_search
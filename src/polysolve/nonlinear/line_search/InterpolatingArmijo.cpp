@@ -0,0 +1,75 @@
+#include "InterpolatingArmijo.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace polysolve::nonlinear::line_search
+{
+    namespace
+    {
+        // Bounds of the next step relative to the rejected one, to avoid tiny or negligible reductions
+        constexpr double MIN_REDUCTION = 0.1;
+        constexpr double MAX_REDUCTION = 0.5;
+    } // namespace
+
+    InterpolatingArmijo::InterpolatingArmijo(const json &params, spdlog::logger &logger)
+        : Superclass(params, logger)
+    {
+    }
+
+    void InterpolatingArmijo::init_compute_descent_step_size(
+        const TVector &delta_x,
+        const TVector &old_grad)
+    {
+        Superclass::init_compute_descent_step_size(delta_x, old_grad);
+
+        directional_derivative = delta_x.dot(old_grad);
+        prev_step_size = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double InterpolatingArmijo::next_step_size(
+        const double old_energy,
+        const double step_size,
+        const double new_energy)
+    {
+        // No energy to fit (invalid step), or not a descent direction
+        if (!std::isfinite(new_energy) || directional_derivative >= 0)
+            return Superclass::next_step_size(old_energy, step_size, new_energy);
+
+        // φ(α) = f(x + α Δx), with φ(0) = old_energy and φ'(0) = directional_derivative
+        const double f0 = old_energy;
+        const double g0 = directional_derivative;
+        const double a1 = step_size;
+        const double d1 = new_energy - f0 - g0 * a1;
+
+        double next;
+        if (std::isnan(prev_step_size))
+        {
+            // Minimizer of the quadratic through φ(0), φ'(0) and φ(α₁)
+            next = -g0 * a1 * a1 / (2 * d1);
+        }
+        else
+        {
+            // Minimizer of the cubic through φ(0), φ'(0), φ(α₀) and φ(α₁)
+            const double a0 = prev_step_size;
+            const double d0 = prev_energy - f0 - g0 * a0;
+            const double denom = a0 * a0 * a1 * a1 * (a1 - a0);
+            const double a = (a0 * a0 * d1 - a1 * a1 * d0) / denom;
+            const double b = (-a0 * a0 * a0 * d1 + a1 * a1 * a1 * d0) / denom;
+
+            if (a == 0)
+                next = -g0 / (2 * b);
+            else
+                next = (-b + std::sqrt(b * b - 3 * a * g0)) / (3 * a);
+        }
+
+        prev_step_size = a1;
+        prev_energy = new_energy;
+
+        if (!std::isfinite(next) || next <= 0)
+            return Superclass::next_step_size(old_energy, step_size, new_energy);
+
+        return std::clamp(next, MIN_REDUCTION * a1, MAX_REDUCTION * a1);
+    }
+
+}; // namespace polysolve::nonlinear::line_search
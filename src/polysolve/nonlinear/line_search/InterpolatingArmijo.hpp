@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Armijo.hpp"
+
+namespace polysolve::nonlinear::line_search
+{
+    /// @brief Armijo line search choosing the next trial step by minimizing a quadratic model of the
+    /// energy along the direction, then cubic models through the last two trials, see Nocedal and
+    /// Wright [2006], Section 3.5. The new step is safeguarded to [0.1, 0.5] times the rejected one.
+    class InterpolatingArmijo : public Armijo
+    {
+    public:
+        using Superclass = Armijo;
+        using typename Superclass::Scalar;
+        using typename Superclass::TVector;
+
+        InterpolatingArmijo(const json &params, spdlog::logger &logger);
+
+        virtual std::string name() override { return "InterpolatingArmijo"; }
+
+    protected:
+        void init_compute_descent_step_size(
+            const TVector &delta_x,
+            const TVector &old_grad) override;
+
+        double next_step_size(
+            const double old_energy,
+            const double step_size,
+            const double new_energy) override;
+
+        // Each trial step depends on the energy of the previous one
+        bool uses_fixed_step_ratio() const override { return false; }
+
+        double directional_derivative; ///< cached value: delta_x.dot(old_grad)
+
+        // Previous rejected trial with a finite energy, used by the cubic model
+        double prev_step_size;
+        double prev_energy;
+    };
+} // namespace polysolve::nonlinear::line_search
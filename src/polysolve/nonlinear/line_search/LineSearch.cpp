@@ -3,6 +3,8 @@
 #include "Armijo.hpp"
 #include "Backtracking.hpp"
 #include "RobustArmijo.hpp"
+#include "NonmonotoneArmijo.hpp"
+#include "InterpolatingArmijo.hpp"
 #include "CppOptArmijo.hpp"
 #include "MoreThuente.hpp"
 #include "NoLineSearch.hpp"
@@ -14,6 +16,7 @@
 #include <spdlog/spdlog.h>
 
 #include <cfenv>
+#include <exception>
 
 namespace polysolve::nonlinear::line_search
 {
@@ -34,6 +37,14 @@ namespace polysolve::nonlinear::line_search
         {
             return std::make_shared<RobustArmijo>(params, logger);
         }
+        else if (name == "nonmonotone_armijo" || name == "NonmonotoneArmijo")
+        {
+            return std::make_shared<NonmonotoneArmijo>(params, logger);
+        }
+        else if (name == "interpolating_armijo" || name == "InterpolatingArmijo")
+        {
+            return std::make_shared<InterpolatingArmijo>(params, logger);
+        }
         else if (name == "bisection" || name == "Bisection")
         {
             logger.warn("{} linesearch was renamed to \"backtracking\"; using backtracking line-search", name);
@@ -63,6 +74,8 @@ namespace polysolve::nonlinear::line_search
         return {{"Armijo",
                  "ArmijoAlt",
                  "RobustArmijo",
+                 "NonmonotoneArmijo",
+                 "InterpolatingArmijo",
                  "Backtracking",
                  "MoreThuente",
                  "None"}};
@@ -81,31 +94,62 @@ namespace polysolve::nonlinear::line_search
         step_ratio = params["line_search"]["step_ratio"];
 
         use_directional_derivative = params["line_search"]["use_directional_derivative"];
+
+        parallel_trials = params["line_search"]["parallel_trials"];
+        if (parallel_trials < 1)
+            log_and_throw_error(logger, "Line search parallel_trials must be >= 1, instead got {}", parallel_trials);
+    }
+
+    void LineSearch::trial_step_sizes(double step_size, const double rate, std::vector<double> &step_sizes) const
+    {
+        step_sizes.clear();
+        for (int i = 0; i < parallel_trials && step_size > current_min_step_size() && cur_iter + i < current_max_step_size_iter(); ++i)
+        {
+            step_sizes.push_back(step_size);
+            step_size *= rate;
+        }
+    }
+
+    void LineSearch::parallel_for(const int n, const std::function<void(int)> &func)
+    {
+        if (!trial_threads)
+            trial_threads = std::make_unique<ThreadPool>(parallel_trials);
+        trial_threads->parallel_for(n, func);
     }
 
     double LineSearch::line_search(
         const TVector &x,
         const TVector &delta_x,
         Problem &objFunc)
+    {
+        double energy;
+        TVector grad;
+        objFunc.compute(x, &energy, &grad, nullptr);
+        return line_search(x, delta_x, objFunc, energy, grad);
+    }
+
+    double LineSearch::line_search(
+        const TVector &x,
+        const TVector &delta_x,
+        Problem &objFunc,
+        const double initial_energy,
+        const TVector &initial_grad)
     {
         // ----------------
         // Begin linesearch
         // ----------------
-        double initial_energy, step_size;
-        TVector initial_grad;
+        double step_size;
         {
             POLYSOLVE_SCOPED_STOPWATCH("LS begin", m_logger);
 
             cur_iter = 0;
 
-            initial_energy = objFunc.value(x);
             if (std::isnan(initial_energy))
             {
                 m_logger.error("Original energy in line search is nan!");
                 return NaN;
             }
 
-            objFunc.gradient(x, initial_grad);
             if (!initial_grad.array().isFinite().all())
             {
                 m_logger.error("Original gradient in line search is nan!");
@@ -168,12 +212,11 @@ namespace polysolve::nonlinear::line_search
             }
         }
 
-        const double cur_energy = objFunc.value(x + step_size * delta_x);
-
         const double descent_step_size = step_size;
 
         if (cur_iter >= current_max_step_size_iter() || step_size <= current_min_step_size())
         {
+            const double cur_energy = objFunc.value(x + step_size * delta_x);
             m_logger.log(is_final_strategy ? spdlog::level::warn : spdlog::level::debug,
                          "Line search failed to find descent step (f(x)={:g} f(x+αΔx)={:g} α_CCD={:g} α={:g}, ||Δx||={:g}  use_grad_norm={} iter={:d})",
                          initial_energy, cur_energy, starting_step_size,
@@ -207,25 +250,74 @@ namespace polysolve::nonlinear::line_search
         const double rate)
     {
         double step_size = starting_step_size;
-        TVector new_x = x + step_size * delta_x;
 
-        // Find step that does not result in nan or infinite energy
-        while (step_size > current_min_step_size() && cur_iter < current_max_step_size_iter())
+        if (use_parallel_trials(objFunc))
         {
-            // Compute the new energy value without contacts
-            const double energy = objFunc.value(new_x);
-            const bool is_step_valid = objFunc.is_step_valid(x, new_x);
-
-            if (!std::isfinite(energy) || !is_step_valid)
+            // Evaluate batches of trial steps concurrently and keep the largest valid one
+            std::vector<double> step_sizes;
+            std::vector<char> is_valid;
+            std::vector<std::exception_ptr> errors;
+            bool found = false;
+            while (!found && step_size > current_min_step_size() && cur_iter < current_max_step_size_iter())
             {
-                step_size *= rate;
-                new_x = x + step_size * delta_x;
+                trial_step_sizes(step_size, rate, step_sizes);
+                const int n = step_sizes.size();
+                is_valid.assign(n, false);
+                errors.assign(n, nullptr);
+
+                // As in the serial search, the trial steps are evaluated with the state at x
+                parallel_for(n, [&](const int i) {
+                    try
+                    {
+                        objFunc.trial_solution_changed(x, i);
+                        const TVector trial_x = x + step_sizes[i] * delta_x;
+                        is_valid[i] = std::isfinite(objFunc.value(trial_x)) && objFunc.is_step_valid(x, trial_x);
+                    }
+                    catch (...)
+                    {
+                        errors[i] = std::current_exception();
+                    }
+                });
+
+                for (int i = 0; i < n; ++i)
+                {
+                    step_size = step_sizes[i];
+                    if (errors[i])
+                        std::rethrow_exception(errors[i]);
+                    if (is_valid[i])
+                    {
+                        found = true;
+                        break;
+                    }
+                    cur_iter++;
+                }
+
+                if (!found)
+                    step_size *= rate;
             }
-            else
+        }
+        else
+        {
+            TVector new_x = x + step_size * delta_x;
+
+            // Find step that does not result in nan or infinite energy
+            while (step_size > current_min_step_size() && cur_iter < current_max_step_size_iter())
             {
-                break;
+                // Compute the new energy value without contacts
+                const double energy = objFunc.value(new_x);
+                const bool is_step_valid = objFunc.is_step_valid(x, new_x);
+
+                if (!std::isfinite(energy) || !is_step_valid)
+                {
+                    step_size *= rate;
+                    new_x = x + step_size * delta_x;
+                }
+                else
+                {
+                    break;
+                }
+                cur_iter++;
             }
-            cur_iter++;
         }
 
         if (cur_iter >= current_max_step_size_iter() || step_size <= current_min_step_size())
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "ThreadPool.hpp"
+
 #include <polysolve/nonlinear/Problem.hpp>
 
+#include <functional>
+#include <memory>
+
 namespace spdlog
 {
     class logger;
@@ -20,15 +25,26 @@ namespace polysolve::nonlinear::line_search
 
         double line_search(
             const TVector &x,
-            const TVector &grad,
+            const TVector &delta_x,
             Problem &objFunc);
 
+        // Same as above, reusing the energy and gradient already evaluated at x
+        double line_search(
+            const TVector &x,
+            const TVector &delta_x,
+            Problem &objFunc,
+            const double initial_energy,
+            const TVector &initial_grad);
+
         static std::shared_ptr<LineSearch> create(
             const json &params,
             spdlog::logger &logger);
 
         static std::vector<std::string> available_methods();
 
+        // Called at the beginning of each minimization, for line searches keeping a history
+        virtual void reset() {}
+
         void reset_times()
         {
             checking_for_nan_inf_time = 0;
@@ -76,12 +92,24 @@ namespace polysolve::nonlinear::line_search
 
         double default_init_step_size;
 
+        std::unique_ptr<ThreadPool> trial_threads; ///< Created at the first parallel evaluation
+
     protected:
         int cur_iter;
         spdlog::logger &m_logger;
 
         double step_ratio;
 
+        int parallel_trials; ///< Number of trial steps evaluated concurrently for thread-safe problems
+
+        bool use_parallel_trials(const Problem &objFunc) const { return parallel_trials > 1 && objFunc.is_thread_safe(); }
+
+        // Next batch of trial step sizes step_size, step_size * rate, ... within the step size and iteration limits
+        void trial_step_sizes(double step_size, const double rate, std::vector<double> &step_sizes) const;
+
+        // Calls func(i) for i in [0, n) on the trial threads, func(i) always runs on the same thread
+        void parallel_for(const int n, const std::function<void(int)> &func);
+
         virtual double compute_descent_step_size(
             const TVector &x,
             const TVector &delta_x,
@@ -16,6 +16,7 @@ namespace polysolve::nonlinear::line_search
         const TVector &old_grad,
         const TVector &new_x,
         const double new_energy,
+        const TVector &new_grad,
         const double step_size) const
     {
         // if (use_grad_norm)
@@ -15,6 +15,8 @@ namespace polysolve::nonlinear::line_search
         virtual std::string name() override { return "None"; }
 
     protected:
+        bool criteria_needs_gradient(const bool use_grad_norm) const override { return false; }
+
         bool criteria(
             const TVector &delta_x,
             Problem &objFunc,
@@ -23,6 +25,7 @@ namespace polysolve::nonlinear::line_search
             const TVector &old_grad,
             const TVector &new_x,
             const double new_energy,
+            const TVector &new_grad,
             const double step_size) const override;
         
     private:
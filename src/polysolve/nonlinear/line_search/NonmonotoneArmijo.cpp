@@ -0,0 +1,92 @@
+#include "NonmonotoneArmijo.hpp"
+
+#include <polysolve/Utils.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace polysolve::nonlinear::line_search
+{
+    NonmonotoneArmijo::NonmonotoneArmijo(const json &params, spdlog::logger &logger)
+        : Superclass(params, logger)
+    {
+        const json &nonmonotone_params = params["line_search"]["NonmonotoneArmijo"];
+        use_average = nonmonotone_params["reference"] == "average";
+        window = nonmonotone_params["window"];
+        eta = nonmonotone_params["eta"];
+
+        if (window < 1)
+            log_and_throw_error(logger, "NonmonotoneArmijo window must be >= 1, instead got {}", window);
+
+        if (eta < 0 || eta > 1)
+            log_and_throw_error(logger, "NonmonotoneArmijo eta must be in [0, 1], instead got {}", eta);
+
+        reset();
+    }
+
+    void NonmonotoneArmijo::reset()
+    {
+        Superclass::reset();
+
+        energies.clear();
+        average_weight = 0;
+        last_x.resize(0);
+    }
+
+    void NonmonotoneArmijo::add_energy(const double energy)
+    {
+        if (use_average)
+        {
+            // C_{k+1} = (η Q_k C_k + f_{k+1}) / Q_{k+1}, Q_{k+1} = η Q_k + 1
+            const double new_weight = eta * average_weight + 1;
+            average_energy = average_weight == 0 ? energy : ((eta * average_weight * average_energy + energy) / new_weight);
+            average_weight = new_weight;
+            reference_energy = average_energy;
+        }
+        else
+        {
+            energies.push_back(energy);
+            if (int(energies.size()) > window)
+                energies.pop_front();
+            reference_energy = *std::max_element(energies.begin(), energies.end());
+        }
+    }
+
+    double NonmonotoneArmijo::compute_descent_step_size(
+        const TVector &x,
+        const TVector &delta_x,
+        Problem &objFunc,
+        const bool use_grad_norm,
+        const double old_energy,
+        const TVector &old_grad,
+        const double starting_step_size)
+    {
+        if (last_x.size() != x.size() || last_x != x)
+        {
+            add_energy(old_energy);
+            last_x = x;
+        }
+
+        // The reference is at least the current energy, but the latter may be slightly larger due to round-off
+        reference_energy = std::max(reference_energy, old_energy);
+
+        return Superclass::compute_descent_step_size(
+            x, delta_x, objFunc, use_grad_norm, old_energy, old_grad, starting_step_size);
+    }
+
+    bool NonmonotoneArmijo::criteria(
+        const TVector &delta_x,
+        Problem &objFunc,
+        const bool use_grad_norm,
+        const double old_energy,
+        const TVector &old_grad,
+        const TVector &new_x,
+        const double new_energy,
+        const TVector &new_grad,
+        const double step_size) const
+    {
+        return new_energy <= reference_energy + step_size * armijo_criteria;
+    }
+
+}; // namespace polysolve::nonlinear::line_search
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Armijo.hpp"
+
+#include <deque>
+
+namespace polysolve::nonlinear::line_search
+{
+    /// @brief Armijo line search relative to a reference energy over the past iterates instead of the
+    /// current energy: the maximum over a window (Grippo et al. [1986]) or a weighted average (Zhang
+    /// and Hager [2004]). The energy may increase between iterations, allowing larger steps.
+    class NonmonotoneArmijo : public Armijo
+    {
+    public:
+        using Superclass = Armijo;
+        using typename Superclass::Scalar;
+        using typename Superclass::TVector;
+
+        NonmonotoneArmijo(const json &params, spdlog::logger &logger);
+
+        virtual std::string name() override { return "NonmonotoneArmijo"; }
+
+        void reset() override;
+
+        double compute_descent_step_size(
+            const TVector &x,
+            const TVector &delta_x,
+            Problem &objFunc,
+            const bool use_grad_norm,
+            const double old_energy,
+            const TVector &old_grad,
+            const double starting_step_size) override;
+
+    protected:
+        bool criteria(
+            const TVector &delta_x,
+            Problem &objFunc,
+            const bool use_grad_norm,
+            const double old_energy,
+            const TVector &old_grad,
+            const TVector &new_x,
+            const double new_energy,
+            const TVector &new_grad,
+            const double step_size) const override;
+
+        // Adds the energy of a new iterate to the history and updates the reference energy
+        void add_energy(const double energy);
+
+        bool use_average; ///< Zhang-Hager average instead of the Grippo-Lampariello-Lucidi maximum
+        int window;       ///< Number of past energies in the maximum
+        double eta;       ///< Weight of the past energies in the average
+
+        std::deque<double> energies; ///< Energies of the last iterates
+        double average_energy;       ///< Zhang-Hager C_k
+        double average_weight;       ///< Zhang-Hager Q_k
+        double reference_energy;
+
+        TVector last_x; ///< Iterate of the last recorded energy, retries at the same x do not add it again
+    };
+
+} // namespace polysolve::nonlinear::line_search
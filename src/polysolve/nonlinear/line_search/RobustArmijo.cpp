@@ -21,6 +21,7 @@ namespace polysolve::nonlinear::line_search
         const TVector &old_grad,
         const TVector &new_x,
         const double new_energy,
+        const TVector &new_grad,
         const double step_size) const
     {
         if (new_energy <= old_energy + step_size * this->armijo_criteria) // Try Armijo first
@@ -28,11 +29,12 @@ namespace polysolve::nonlinear::line_search
 
         if (std::abs(new_energy - old_energy) <= delta_relative_tolerance * std::abs(old_energy))
         {
-            TVector new_grad;
-            objFunc.gradient(new_x, new_grad);
+            // only needed when the energy change is within round-off, so not evaluated with the energy
+            TVector grad;
+            objFunc.gradient(new_x, grad);
 
-            const double deltaE_approx = step_size / 2 * delta_x.dot(new_grad + old_grad);
-            const double abs_eps_est = step_size / 2 * std::abs(delta_x.dot(new_grad - old_grad));
+            const double deltaE_approx = step_size / 2 * delta_x.dot(grad + old_grad);
+            const double abs_eps_est = step_size / 2 * std::abs(delta_x.dot(grad - old_grad));
 
             if (deltaE_approx + abs_eps_est <= step_size * this->armijo_criteria)
                 return true;
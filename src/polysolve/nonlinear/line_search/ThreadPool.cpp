@@ -0,0 +1,70 @@
+#include "ThreadPool.hpp"
+
+#include <cassert>
+
+namespace polysolve::nonlinear::line_search
+{
+    ThreadPool::ThreadPool(const int num_threads)
+    {
+        workers.reserve(num_threads);
+        for (int i = 0; i < num_threads; ++i)
+            workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start_cv.notify_all();
+
+        for (auto &t : workers)
+            t.join();
+    }
+
+    void ThreadPool::parallel_for(const int n, const std::function<void(int)> &func)
+    {
+        assert(n <= size());
+        if (n <= 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &func;
+            task_size = n;
+            pending = n;
+            ++generation;
+        }
+        start_cv.notify_all();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&] { return pending == 0; });
+        task = nullptr;
+    }
+
+    void ThreadPool::worker_loop(const int id)
+    {
+        int last_generation = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            start_cv.wait(lock, [&] { return stopping || generation != last_generation; });
+            if (stopping)
+                return;
+
+            last_generation = generation;
+            if (id >= task_size)
+                continue;
+
+            const std::function<void(int)> &func = *task;
+            lock.unlock();
+            func(id);
+            lock.lock();
+
+            if (--pending == 0)
+                done_cv.notify_one();
+        }
+    }
+} // namespace polysolve::nonlinear::line_search
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace polysolve::nonlinear::line_search
+{
+    /// @brief Fixed set of worker threads kept alive across parallel_for calls, so that batches of
+    /// line-search trials do not pay for thread creation. Task i always runs on worker i.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(const int num_threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        int size() const { return workers.size(); }
+
+        // Calls func(i) on worker i for i in [0, n), n <= size(), and waits for all of them.
+        // func must not throw.
+        void parallel_for(const int n, const std::function<void(int)> &func);
+
+    private:
+        void worker_loop(const int id);
+
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable start_cv;
+        std::condition_variable done_cv;
+
+        const std::function<void(int)> *task = nullptr;
+        int task_size = 0;
+        int generation = 0; ///< Incremented for every parallel_for call
+        int pending = 0;    ///< Number of tasks of the current call still running
+        bool stopping = false;
+    };
+} // namespace polysolve::nonlinear::line_search
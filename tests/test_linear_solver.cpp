@@ -15,6 +15,7 @@
 #include <unsupported/Eigen/SparseExtra>
 #include <fstream>
 #include <vector>
+#include <functional>
 #include <ctime>
 #include <chrono>
 //////////////////////////////////////////////////////////////////////////
@@ -49,6 +50,35 @@ void loadSymmetric(Eigen::SparseMatrix<double> &A, std::string PATH)
     A.setFromTriplets(triple.begin(), triple.end());
 };
 
+// Symmetric saddle point system [A B; Bᵀ C] with an SPD n x n block A
+StiffnessMatrix saddle_point_matrix(const int n, const int m)
+{
+    std::vector<Eigen::Triplet<double>> triples;
+    for (int i = 0; i < n; ++i)
+    {
+        triples.emplace_back(i, i, 4 + i % 3);
+        if (i + 1 < n)
+        {
+            triples.emplace_back(i, i + 1, -1);
+            triples.emplace_back(i + 1, i, -1);
+        }
+    }
+    for (int j = 0; j < m; ++j)
+    {
+        for (int i = j; i < n; i += m)
+        {
+            const double b = 0.5 + 0.1 * (i % 4);
+            triples.emplace_back(i, n + j, b);
+            triples.emplace_back(n + j, i, b);
+        }
+        triples.emplace_back(n + j, n + j, -1);
+    }
+
+    StiffnessMatrix A(n + m, n + m);
+    A.setFromTriplets(triples.begin(), triples.end());
+    return A;
+}
+
 TEST_CASE("jse", "[solver]")
 {
     const std::string path = POLYFEM_DATA_DIR;
@@ -156,6 +186,227 @@ TEST_CASE("all", "[solver]")
     }
 }
 
+TEST_CASE("multi_rhs", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    auto solvers = Solver::available_solvers();
+
+    for (const auto &s : solvers)
+    {
+        if (s == "Eigen::DGMRES")
+            continue;
+#ifdef WIN32
+        if (s == "Eigen::ConjugateGradient" || s == "Eigen::BiCGSTAB" || s == "Eigen::GMRES" || s == "Eigen::MINRES")
+            continue;
+#endif
+        auto solver = Solver::create(s, "");
+        json params;
+        params[s]["tolerance"] = 1e-10;
+        solver->set_parameters(params);
+        Eigen::MatrixXd B(A.rows(), 3);
+        B.setRandom();
+        Eigen::MatrixXd X;
+
+        if (solver->is_dense())
+        {
+            solver->analyze_pattern_dense(A, A.rows());
+            solver->factorize_dense(A);
+        }
+        else
+        {
+            solver->analyze_pattern(A, A.rows());
+            solver->factorize(A);
+        }
+
+        solver->solve(B, X);
+
+        REQUIRE(X.rows() == B.rows());
+        REQUIRE(X.cols() == B.cols());
+        for (int i = 0; i < B.cols(); ++i)
+        {
+            const double err = (A * X.col(i) - B.col(i)).norm();
+            INFO("solver: " + s + " column: " + std::to_string(i));
+            REQUIRE(err < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("matrix_free", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    auto solvers = Solver::available_solvers();
+
+    for (const auto &s : solvers)
+    {
+        if (s == "Eigen::DGMRES")
+            continue;
+        auto solver = Solver::create(s, "");
+        if (!solver->supports_matrix_free())
+        {
+            CHECK_THROWS(solver->factorize_operator(SparseMatrixOperator(A)));
+            continue;
+        }
+        json params;
+        params[s]["tolerance"] = 1e-10;
+        solver->set_parameters(params);
+
+        // Jacobi and block-Jacobi preconditioning
+        for (const int block_size : {1, 3})
+        {
+            const SparseMatrixOperator op(A, block_size);
+            solver->factorize_operator(op);
+
+            Eigen::VectorXd b(A.rows());
+            b.setRandom();
+            Eigen::VectorXd x(A.rows());
+            x.setZero();
+            solver->solve(b, x);
+
+            const double err = (A * x - b).norm();
+            INFO("solver: " + s + " block size: " + std::to_string(block_size));
+            REQUIRE(err < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("refactorize_shifted", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    Eigen::SparseMatrix<double> I(A.rows(), A.cols());
+    I.setIdentity();
+
+    auto solvers = Solver::available_solvers();
+
+    for (const auto &s : solvers)
+    {
+        auto solver = Solver::create(s, "");
+        if (solver->is_dense())
+            continue;
+
+        solver->analyze_pattern(A, A.rows());
+        solver->factorize(A);
+
+        for (const double sigma : {1e-2, 1.0})
+        {
+            if (!solver->refactorize_shifted(A, sigma))
+                break;
+
+            Eigen::VectorXd b(A.rows());
+            b.setRandom();
+            Eigen::VectorXd x(A.rows());
+            x.setZero();
+            solver->solve(b, x);
+
+            const double err = ((A + sigma * I) * x - b).norm();
+            INFO("solver: " + s + " sigma: " + std::to_string(sigma));
+            REQUIRE(err < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("mixed_precision", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    for (const std::string inner : {"Eigen::SimplicialLDLT", "Eigen::SimplicialLLT", "Eigen::SparseLU"})
+    {
+        double single_step_err = 0;
+        for (const int max_iter : {1, 10})
+        {
+            json params;
+            params["solver"] = "MixedPrecisionRefinement";
+            params["MixedPrecisionRefinement"]["inner_solver"] = inner;
+            params["MixedPrecisionRefinement"]["max_iter"] = max_iter;
+            auto solver = Solver::create(params, *spdlog::default_logger());
+
+            solver->analyze_pattern(A, A.rows());
+            solver->factorize(A);
+
+            Eigen::VectorXd x(A.rows());
+            solver->solve(b, x);
+
+            json info;
+            solver->get_info(info);
+
+            const double err = (A * x - b).norm();
+            INFO("inner solver: " + inner + " max_iter: " + std::to_string(max_iter));
+            CHECK(info["num_iterations"] <= max_iter);
+            CHECK(info["final_res_norm"].get<double>() == Approx(err / b.norm()).epsilon(1e-6).margin(1e-12));
+
+            if (max_iter == 1)
+            {
+                // A single precision solve alone is not accurate enough
+                single_step_err = err;
+                CHECK(err > 1e-8);
+                CHECK(info["num_iterations"] == max_iter);
+            }
+            else
+            {
+                CHECK(err < 1e-8);
+                CHECK(err < single_step_err);
+            }
+        }
+    }
+}
+
+TEST_CASE("rigid_body_modes", "[solver]")
+{
+    for (int dim = 2; dim <= 3; ++dim)
+    {
+        Eigen::MatrixXd V(10, dim);
+        V.setRandom();
+
+        const Eigen::MatrixXd B = rigid_body_modes(V);
+        REQUIRE(B.rows() == V.rows() * dim);
+        REQUIRE(B.cols() == (dim == 2 ? 3 : 6));
+        REQUIRE((B.transpose() * B - Eigen::MatrixXd::Identity(B.cols(), B.cols())).norm() < 1e-12);
+
+        // Translation along x and rotation around z (about the origin) are in the span of the modes
+        Eigen::VectorXd t = Eigen::VectorXd::Zero(B.rows());
+        Eigen::VectorXd r = Eigen::VectorXd::Zero(B.rows());
+        for (int i = 0; i < V.rows(); ++i)
+        {
+            t(i * dim) = 1;
+            r(i * dim + 0) = -V(i, 1);
+            r(i * dim + 1) = V(i, 0);
+        }
+        REQUIRE((B * (B.transpose() * t) - t).norm() < 1e-10);
+        REQUIRE((B * (B.transpose() * r) - r).norm() < 1e-10);
+
+        const Eigen::MatrixXd R = rigid_body_modes(V, true);
+        REQUIRE(R.cols() == (dim == 2 ? 1 : 3));
+
+        // The translations and the dimension are recovered from the modes
+        Eigen::MatrixXd others;
+        REQUIRE(split_translations(B, others) == dim);
+        REQUIRE(others.cols() == R.cols());
+        REQUIRE((t.transpose() * others).norm() < 1e-10);
+        REQUIRE((R * (R.transpose() * others) - others).norm() < 1e-10);
+
+        Eigen::MatrixXd random(B.rows(), B.cols());
+        random.setRandom();
+        REQUIRE(split_translations(random, others) == 1);
+    }
+}
+
 TEST_CASE("eigen_params", "[solver]")
 {
     const std::string path = POLYFEM_DATA_DIR;
@@ -262,6 +513,82 @@ TEST_CASE("pre_factor", "[solver]")
     }
 }
 
+TEST_CASE("pardiso_pattern", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    std::default_random_engine eng{42};
+    std::uniform_real_distribution<double> urd(0.1, 5);
+
+    // Random symmetric diagonally dominant values on the pattern of A, without the
+    // off-diagonal entries rejected by keep
+    const auto random_values = [&](const std::function<bool(int, int)> &keep) {
+        std::vector<Eigen::Triplet<double>> tripletList;
+        for (int k = 0; k < A.outerSize(); ++k)
+        {
+            for (Eigen::SparseMatrix<double>::InnerIterator it(A, k); it; ++it)
+            {
+                if (it.row() == it.col())
+                {
+                    tripletList.emplace_back(it.row(), it.col(), urd(eng) * 1000);
+                }
+                else if (it.row() < it.col() && keep(it.row(), it.col()))
+                {
+                    const double val = -urd(eng);
+                    tripletList.emplace_back(it.row(), it.col(), val);
+                    tripletList.emplace_back(it.col(), it.row(), val);
+                }
+            }
+        }
+
+        Eigen::SparseMatrix<double> Atmp(A.rows(), A.cols());
+        Atmp.setFromTriplets(tripletList.begin(), tripletList.end());
+        return Atmp;
+    };
+
+    for (const int mtype : {2, 11})
+    {
+        std::unique_ptr<Solver> solver;
+        try
+        {
+            solver = Solver::create("Pardiso", "");
+        }
+        catch (const std::exception &)
+        {
+            return;
+        }
+        json params;
+        params["Pardiso"]["mtype"] = mtype;
+        solver->set_parameters(params);
+
+        const Eigen::SparseMatrix<double> A0 = random_values([](int, int) { return true; });
+        // Same pattern as A0, the reordering is reused
+        const Eigen::SparseMatrix<double> A1 = random_values([](int, int) { return true; });
+        // Fewer entries, the indices and the reordering must be recomputed
+        const Eigen::SparseMatrix<double> A2 = random_values([](int i, int j) { return (i + j) % 3 != 0; });
+        REQUIRE(A2.nonZeros() < A0.nonZeros());
+
+        for (const Eigen::SparseMatrix<double> *Ai : {&A0, &A1, &A2})
+        {
+            Eigen::VectorXd b(Ai->rows());
+            b.setRandom();
+            Eigen::VectorXd x(b.size());
+            x.setZero();
+
+            solver->analyze_pattern(*Ai, Ai->rows());
+            solver->factorize(*Ai);
+            solver->solve(b, x);
+
+            const double err = (*Ai * x - b).norm();
+            INFO("mtype: " << mtype);
+            REQUIRE(err < 1e-8);
+        }
+    }
+}
+
 TEST_CASE("hypre", "[solver]")
 {
     std::unique_ptr<Solver> solver;
@@ -353,6 +680,120 @@ TEST_CASE("hypre_initial_guess", "[solver]")
     REQUIRE(err < 1e-8);
 }
 
+TEST_CASE("hypre_reuse_amg", "[solver]")
+{
+    std::unique_ptr<Solver> solver;
+
+    try
+    {
+        solver = Solver::create("Hypre", "");
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    json params;
+    params["Hypre"]["amg_reuse"] = 1;
+    solver->set_parameters(params);
+
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    solver->analyze_pattern(A, A.rows());
+    for (int k = 0; k < 3; ++k)
+    {
+        // Slightly perturbed matrix, as in successive Newton iterations
+        Eigen::SparseMatrix<double> Ak = A;
+        for (int i = 0; i < Ak.rows(); ++i)
+            Ak.coeffRef(i, i) *= 1 + 1e-3 * k;
+
+        solver->factorize(Ak);
+
+        json solver_info;
+        solver->get_info(solver_info);
+        REQUIRE(solver_info["amg_reused"] == (k == 1));
+
+        // Several solves against the same factorization
+        for (int l = 0; l < 2; ++l)
+        {
+            Eigen::VectorXd x(b.size());
+            x.setZero();
+            solver->solve(b, x);
+
+            const double err = (Ak * x - b).norm();
+            REQUIRE(err < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("hypre_near_nullspace", "[solver]")
+{
+    std::unique_ptr<Solver> solver;
+
+    try
+    {
+        solver = Solver::create("Hypre", "");
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+
+    // Vector Laplacian on a grid, with the two components interleaved per vertex
+    const int n = 20;
+    const int dim = 2;
+    Eigen::MatrixXd V(n * n, dim);
+    std::vector<Eigen::Triplet<double>> triples;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            const int v = i * n + j;
+            V.row(v) << i, j;
+            for (int d = 0; d < dim; ++d)
+            {
+                triples.emplace_back(v * dim + d, v * dim + d, 4.01);
+                if (i + 1 < n)
+                {
+                    triples.emplace_back(v * dim + d, (v + n) * dim + d, -1);
+                    triples.emplace_back((v + n) * dim + d, v * dim + d, -1);
+                }
+                if (j + 1 < n)
+                {
+                    triples.emplace_back(v * dim + d, (v + 1) * dim + d, -1);
+                    triples.emplace_back((v + 1) * dim + d, v * dim + d, -1);
+                }
+            }
+        }
+    }
+    StiffnessMatrix A(n * n * dim, n * n * dim);
+    A.setFromTriplets(triples.begin(), triples.end());
+
+    // A near-nullspace without the translations cannot be used by the nodal systems AMG
+    Eigen::MatrixXd random(A.rows(), 3);
+    random.setRandom();
+    REQUIRE_THROWS(solver->set_near_nullspace(random));
+
+    solver->set_near_nullspace(rigid_body_modes(V));
+
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+    Eigen::VectorXd x(A.rows());
+    x.setZero();
+
+    solver->analyze_pattern(A, A.rows());
+    solver->factorize(A);
+    solver->solve(b, x);
+
+    const double err = (A * x - b).norm();
+    REQUIRE(err < 1e-8);
+}
+
 TEST_CASE("amgcl_initial_guess", "[solver]")
 {
     const std::string path = POLYFEM_DATA_DIR;
@@ -410,6 +851,141 @@ TEST_CASE("amgcl_initial_guess", "[solver]")
     REQUIRE(err < 1e-8);
 }
 
+TEST_CASE("amgcl_params", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    std::unique_ptr<Solver> solver;
+    try
+    {
+        solver = Solver::create("AMGCL", "");
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+
+    json params;
+    params["AMGCL"]["solver"]["tol"] = 1e-4;
+    solver->set_parameters(params);
+
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    solver->analyze_pattern(A, A.rows());
+    solver->factorize(A);
+
+    json solver_info;
+    Eigen::VectorXd x_loose = Eigen::VectorXd::Zero(A.rows());
+    solver->solve(b, x_loose);
+    solver->get_info(solver_info);
+    const int loose_iterations = solver_info["num_iterations"];
+
+    // The tolerance only changes the Krylov solver, the preconditioner is kept
+    solver->set_tolerance(1e-10);
+    Eigen::VectorXd x_tight = Eigen::VectorXd::Zero(A.rows());
+    solver->solve(b, x_tight);
+    solver->get_info(solver_info);
+    const int tight_iterations = solver_info["num_iterations"];
+
+    REQUIRE(tight_iterations > loose_iterations);
+    REQUIRE((A * x_tight - b).norm() < (A * x_loose - b).norm());
+    REQUIRE((A * x_tight - b).norm() / b.norm() < 1e-8);
+
+    // Block value types cannot use a near-nullspace
+    auto block_solver = Solver::create("AMGCL", "");
+    json block_params;
+    block_params["AMGCL"]["block_size"] = 3;
+    block_solver->set_parameters(block_params);
+    REQUIRE_THROWS(block_solver->set_near_nullspace(Eigen::MatrixXd::Ones(A.rows(), 1)));
+}
+
+TEST_CASE("amgcl_multi_rhs", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    std::unique_ptr<Solver> solver;
+    try
+    {
+        solver = Solver::create("AMGCL", "");
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+    solver->analyze_pattern(A, A.rows());
+    solver->factorize(A);
+
+    Eigen::MatrixXd b(A.rows(), 3);
+    b.setRandom();
+
+    Eigen::MatrixXd x;
+    solver->solve(b, x);
+    REQUIRE(x.rows() == b.rows());
+    REQUIRE(x.cols() == b.cols());
+    REQUIRE((A * x - b).norm() < 1e-8);
+
+    // Solving in place into a column of a larger matrix, the other columns are left untouched
+    Eigen::MatrixXd y = Eigen::MatrixXd::Ones(A.rows(), 3);
+    y.col(1).setZero();
+    solver->solve(b.col(1), y.col(1));
+    REQUIRE((A * y.col(1) - b.col(1)).norm() < 1e-8);
+    REQUIRE(y.col(0).isOnes());
+    REQUIRE(y.col(2).isOnes());
+}
+
+TEST_CASE("amgcl_rebuild", "[solver]")
+{
+    const std::string path = POLYFEM_DATA_DIR;
+    Eigen::SparseMatrix<double> A;
+    const bool ok = loadMarket(A, path + "/A_2.mat");
+    REQUIRE(ok);
+
+    std::unique_ptr<Solver> solver;
+    try
+    {
+        solver = Solver::create("AMGCL", "");
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+
+    json params;
+    params["AMGCL"]["rebuild_every"] = 2;
+    solver->set_parameters(params);
+
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    json solver_info;
+    solver->analyze_pattern(A, A.rows());
+    solver->factorize(A);
+    solver->get_info(solver_info);
+    REQUIRE(solver_info["rebuild"] == "full");
+
+    // Same pattern, different values: the hierarchy is only refreshed
+    StiffnessMatrix A2 = A;
+    A2.diagonal() *= 1.1;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        solver->factorize(A2);
+        solver->get_info(solver_info);
+        REQUIRE(solver_info["rebuild"] == (i == 0 ? "numeric" : "full"));
+
+        Eigen::VectorXd x = Eigen::VectorXd::Zero(A.rows());
+        solver->solve(b, x);
+        REQUIRE((A2 * x - b).norm() < 1e-8);
+    }
+}
+
 TEST_CASE("saddle_point_test", "[solver]")
 {
 #ifdef WIN32
@@ -441,6 +1017,118 @@ TEST_CASE("saddle_point_test", "[solver]")
     REQUIRE(err < 1e-8);
 }
 
+TEST_CASE("saddle_point_params", "[solver]")
+{
+    const int n = 60, m = 12;
+    const StiffnessMatrix A = saddle_point_matrix(n, m);
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    std::vector<double> residuals;
+    for (const int inner_iter : {1, 1000})
+    {
+        // Inner solver settings are old-style linear solver settings
+        json params;
+        params["max_iter"] = 3;
+        params["asymmetric_solver_name"] = "Eigen::GMRES";
+        params["asymmetric_solver_params"]["Eigen::GMRES"]["max_iter"] = inner_iter;
+        params["asymmetric_solver_params"]["Eigen::GMRES"]["tolerance"] = 1e-12;
+        params["symmetric_solver_name"] = "Eigen::GMRES";
+        params["symmetric_solver_params"]["Eigen::GMRES"]["max_iter"] = inner_iter;
+        params["symmetric_solver_params"]["Eigen::GMRES"]["tolerance"] = 1e-12;
+
+        auto solver = Solver::create("SaddlePointSolver", "");
+        solver->set_parameters(params);
+        solver->analyze_pattern(A, n);
+        solver->factorize(A);
+
+        Eigen::VectorXd x(A.rows());
+        x.setZero();
+        solver->solve(b, x);
+
+        json solver_info;
+        solver->get_info(solver_info);
+        REQUIRE(solver_info["num_iterations"] <= 3);
+        residuals.push_back((A * x - b).norm());
+    }
+
+    // The inner iteration limit must have been applied
+    REQUIRE(residuals[0] > 10 * residuals[1]);
+
+    // Inner settings are validated against the spec
+    json params;
+    params["asymmetric_solver_params"]["Eigen::GMRES"]["max_iter"] = "many";
+    auto solver = Solver::create("SaddlePointSolver", "");
+    solver->set_parameters(params);
+    solver->analyze_pattern(A, n);
+    REQUIRE_THROWS(solver->factorize(A));
+}
+
+TEST_CASE("saddle_point_iterations", "[solver]")
+{
+    const int n = 60, m = 12;
+    const StiffnessMatrix A = saddle_point_matrix(n, m);
+    Eigen::VectorXd b(A.rows());
+    b.setRandom();
+
+    // Stop before convergence, so that the intermediate iterates are compared
+    json params;
+    params["max_iter"] = 4;
+    params["asymmetric_solver_name"] = "Eigen::SparseLU";
+    params["symmetric_solver_name"] = "Eigen::SparseLU";
+
+    auto solver = Solver::create("SaddlePointSolver", "");
+    solver->set_parameters(params);
+    solver->analyze_pattern(A, n);
+    solver->factorize(A);
+
+    Eigen::VectorXd x(A.rows());
+    x.setZero();
+    solver->solve(b, x);
+
+    json solver_info;
+    solver->get_info(solver_info);
+    const int iterations = solver_info["num_iterations"];
+    REQUIRE(iterations == 4);
+
+    // Reference with the Gram matrices of all residuals recomputed at every iteration
+    const Eigen::MatrixXd Ad = A;
+    const Eigen::VectorXd wm = Ad.diagonal().head(n).cwiseSqrt().cwiseInverse();
+    const Eigen::MatrixXd As = wm.asDiagonal() * Ad.topLeftCorner(n, n) * wm.asDiagonal();
+    const Eigen::MatrixXd Bs = wm.asDiagonal() * Ad.topRightCorner(n, m);
+    const Eigen::MatrixXd Cs = Ad.bottomRightCorner(m, m);
+    const Eigen::PartialPivLU<Eigen::MatrixXd> As_lu(As);
+    const Eigen::PartialPivLU<Eigen::MatrixXd> Ss_lu(Cs - Bs.transpose() * Bs);
+
+    Eigen::VectorXd rs(n + m);
+    rs << wm.cwiseProduct(b.head(n)), b.tail(m);
+    Eigen::VectorXd r = rs;
+
+    Eigen::MatrixXd Y(n + m, 0), R(n + m, 0);
+    Eigen::VectorXd alpha;
+    for (int i = 0; i < iterations; ++i)
+    {
+        const Eigen::VectorXd yp = Ss_lu.solve(r.tail(m) - Bs.transpose() * As_lu.solve(r.head(n)));
+        const Eigen::VectorXd yu = As_lu.solve(r.head(n) - Bs * yp);
+
+        Y.conservativeResize(Eigen::NoChange, 2 * i + 2);
+        R.conservativeResize(Eigen::NoChange, 2 * i + 2);
+        Y.col(2 * i) << yu, Eigen::VectorXd::Zero(m);
+        Y.col(2 * i + 1) << Eigen::VectorXd::Zero(n), yp;
+        R.col(2 * i) << As * yu, Bs.transpose() * yu;
+        R.col(2 * i + 1) << Bs * yp, Cs * yp;
+
+        alpha = (R.transpose() * R).ldlt().solve(R.transpose() * rs);
+        r = rs - R * alpha;
+    }
+
+    Eigen::VectorXd x_ref = Y * alpha;
+    x_ref.head(n) = wm.cwiseProduct(x_ref.head(n));
+
+    REQUIRE((A * x - b).norm() > 1e-8);
+    REQUIRE((x - x_ref).norm() < 1e-10 * x_ref.norm());
+}
+
 #ifdef POLYSOLVE_WITH_AMGCL
 TEST_CASE("amgcl_blocksolver_small_scale", "[solver]")
 {
@@ -3,6 +3,8 @@
 #include <polysolve/nonlinear/Solver.hpp>
 #include <polysolve/nonlinear/BoxConstraintSolver.hpp>
 #include <polysolve/nonlinear/Problem.hpp>
+#include <polysolve/nonlinear/descent_strategies/Newton.hpp>
+#include <polysolve/nonlinear/descent_strategies/TrustRegionNewtonCG.hpp>
 #include <polysolve/Utils.hpp>
 #include <polysolve/Types.hpp>
 #include <polysolve/linear/Solver.hpp>
@@ -11,6 +13,10 @@
 #include <polysolve/JSONUtils.hpp>
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 //////////////////////////////////////////////////////////////////////////
 
 using namespace polysolve;
@@ -33,6 +39,8 @@ public:
     virtual TVector max() = 0;
 
     virtual std::string name() = 0;
+
+    bool signals_objective_changes() const override { return true; }
 };
 
 class AnalyticTestProblem : public TestProblem
@@ -70,6 +78,16 @@ public:
     {
         hessian = wrap(x).getHessian();
     }
+    void compute(const TVector &x, double *f, TVector *gradv, THessian *hessian) override
+    {
+        const AutodiffScalarHessian fx = wrap(x);
+        if (f)
+            *f = fx.getValue();
+        if (gradv)
+            *gradv = fx.getGradient();
+        if (hessian)
+            *hessian = fx.getHessian().sparseView();
+    }
 };
 
 // f=(x(0)+2)^2 + (x(1)-3)^2 +(x(2)-1)^2
@@ -240,6 +258,164 @@ public:
     }
 };
 
+// Provides Hessian-vector products and counts the assembled Hessians
+template <typename Base>
+class HessianVectorProductProblem : public Base
+{
+public:
+    using typename Base::TVector;
+    using typename Base::THessian;
+
+    bool hessian_vector_product(const TVector &x, const TVector &v, TVector &hv) override
+    {
+        THessian h;
+        Base::hessian(x, h);
+        hv = h * v;
+        return true;
+    }
+
+    void hessian(const TVector &x, THessian &hessian) override
+    {
+        ++n_assembled;
+        Base::hessian(x, hessian);
+    }
+
+    void compute(const TVector &x, double *f, TVector *gradv, THessian *hessian) override
+    {
+        if (hessian)
+            ++n_assembled;
+        Base::compute(x, f, gradv, hessian);
+    }
+
+    int n_assembled = 0;
+};
+
+// x₀x₁ + x₀, an indefinite saddle whose Hessian does not store its (zero) diagonal
+class SaddleProblem : public Problem
+{
+public:
+    double value(const TVector &x) override { return x[0] * x[1] + x[0]; }
+    void gradient(const TVector &x, TVector &gradv) override
+    {
+        gradv.resize(2);
+        gradv << x[1] + 1, x[0];
+    }
+    void hessian(const TVector &x, THessian &hessian) override
+    {
+        ++n_assembled;
+        const std::vector<Eigen::Triplet<double>> triplets = {{0, 1, 1}, {1, 0, 1}};
+        hessian.resize(2, 2);
+        hessian.setFromTriplets(triplets.begin(), triplets.end());
+    }
+
+    int n_assembled = 0;
+};
+
+// ½‖x - c‖², whose target c is moved by the second post_step, as adaptive penalties do
+class MovingTargetProblem : public Problem
+{
+public:
+    MovingTargetProblem(const int size, const bool signals_changes)
+        : target(TVector::Zero(size)), signals_changes(signals_changes) {}
+
+    double value(const TVector &x) override { return 0.5 * (x - target).squaredNorm(); }
+    void gradient(const TVector &x, TVector &gradv) override
+    {
+        ++n_gradients;
+        gradv = x - target;
+    }
+    void hessian(const TVector &x, THessian &hessian) override { hessian = sparse_identity(x.size(), x.size()); }
+
+    bool signals_objective_changes() const override { return signals_changes; }
+
+    void post_step(const PostStepData &data) override
+    {
+        if (++n_post_steps == 2)
+        {
+            target.setOnes();
+            invalidate_objective();
+        }
+    }
+
+    TVector target;
+    const bool signals_changes;
+    int n_post_steps = 0;
+    int n_gradients = 0;
+};
+
+// Counts the energy evaluations
+template <typename Base>
+class EnergyCountingProblem : public Base
+{
+public:
+    using typename Base::TVector;
+    using typename Base::THessian;
+
+    double value(const TVector &x) override
+    {
+        ++n_energy;
+        return Base::value(x);
+    }
+
+    void compute(const TVector &x, double *f, TVector *gradv, THessian *hessian) override
+    {
+        if (f)
+            ++n_energy;
+        Base::compute(x, f, gradv, hessian);
+    }
+
+    int n_energy = 0;
+};
+
+// Marks a problem as safe to evaluate concurrently, and checks that trials are evaluated on the
+// thread whose state was updated for them
+template <typename Base>
+class ThreadSafeProblem : public Base
+{
+public:
+    using typename Base::TVector;
+    using typename Base::THessian;
+
+    bool is_thread_safe() const override { return true; }
+
+    void trial_solution_changed(const TVector &new_x, const int thread_id) override
+    {
+        thread_state() = thread_id;
+        ++n_trial_solution_changed;
+    }
+
+    double value(const TVector &x) override
+    {
+        check_thread_state();
+        return Base::value(x);
+    }
+
+    void compute(const TVector &x, double *f, TVector *gradv, THessian *hessian) override
+    {
+        check_thread_state();
+        Base::compute(x, f, gradv, hessian);
+    }
+
+    std::atomic<int> n_trial_solution_changed{0};
+    std::atomic<int> n_missing_state{0};
+
+private:
+    // Worker id of the last trial_solution_changed on this thread
+    static int &thread_state()
+    {
+        static thread_local int id = -1;
+        return id;
+    }
+
+    void check_thread_state()
+    {
+        if (std::this_thread::get_id() != main_thread && thread_state() < 0)
+            ++n_missing_state;
+    }
+
+    const std::thread::id main_thread = std::this_thread::get_id();
+};
+
 class InequalityConstraint : public Problem
 {
 public:
@@ -256,6 +432,37 @@ private:
     const double upper_bound_;
 };
 
+spdlog::logger &test_logger()
+{
+    static std::shared_ptr<spdlog::logger> logger = spdlog::stdout_color_mt("test_logger");
+    logger->set_level(spdlog::level::info);
+    return *logger;
+}
+
+std::unique_ptr<Solver> create_solver(const json &solver_params, const json &linear_solver_params = R"({"solver": "Eigen::SimplicialLDLT"})"_json)
+{
+    const double characteristic_length = 1;
+    return Solver::create(solver_params, linear_solver_params, characteristic_length, test_logger());
+}
+
+// Minimizes prob from x and checks that the result is a stationary point
+void minimize_and_check(Solver &solver, Problem &prob, Problem::TVector &x)
+{
+    solver.minimize(prob, x);
+
+    Problem::TVector g;
+    prob.gradient(x, g);
+    CHECK(g.norm() < 1e-7);
+}
+
+std::unique_ptr<Solver> minimize_and_check(const json &solver_params, Problem &prob, Problem::TVector &x,
+                                           const json &linear_solver_params = R"({"solver": "Eigen::SimplicialLDLT"})"_json)
+{
+    auto solver = create_solver(solver_params, linear_solver_params);
+    minimize_and_check(*solver, prob, x);
+    return solver;
+}
+
 void test_solvers(const std::vector<std::string> &solvers, const int iters, const bool exceptions_are_errors)
 {
     std::vector<std::unique_ptr<TestProblem>> problems;
@@ -481,6 +688,372 @@ TEST_CASE("nonlinear-fallbacks", "[solver]")
     }
 }
 
+TEST_CASE("nonlinear-post-step-objective", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "Newton";
+
+    // The first Newton step reaches the old target, the gradient must be recomputed after post_step moved it
+    std::vector<int> n_gradients;
+    for (const bool signals_changes : {false, true})
+    {
+        INFO("signals changes: " << signals_changes);
+        MovingTargetProblem prob(3, signals_changes);
+        TestProblem::TVector x = -TestProblem::TVector::Ones(3);
+        minimize_and_check(solver_params, prob, x);
+
+        CHECK(prob.n_post_steps > 2);
+        CHECK((x - prob.target).norm() < 1e-7);
+        n_gradients.push_back(prob.n_gradients);
+    }
+
+    // Only the invalidated evaluation is repeated
+    CHECK(n_gradients[1] < n_gradients[0]);
+}
+
+TEST_CASE("nonlinear-inexact-newton", "[solver]")
+{
+    json solver_params, linear_solver_params;
+    solver_params["solver"] = "Newton";
+    solver_params["max_iterations"] = 100;
+    linear_solver_params["solver"] = "Eigen::ConjugateGradient";
+
+    QuadraticProblem quadratic;
+    Sphere sphere;
+
+    for (const int forcing_term : {1, 2})
+    {
+        solver_params["Newton"]["forcing_term"] = forcing_term;
+        for (TestProblem *prob : std::vector<TestProblem *>{&quadratic, &sphere})
+        {
+            INFO("forcing term: " << forcing_term << " problem " + prob->name());
+            TestProblem::TVector x = TestProblem::TVector::Random(prob->size());
+            minimize_and_check(solver_params, *prob, x, linear_solver_params);
+        }
+    }
+}
+
+TEST_CASE("nonlinear-matrix-free-newton", "[solver]")
+{
+    json solver_params, linear_solver_params;
+    solver_params["solver"] = "Newton";
+    solver_params["max_iterations"] = 100;
+    solver_params["Newton"]["matrix_free"] = true;
+    linear_solver_params["solver"] = "Eigen::ConjugateGradient";
+
+    HessianVectorProductProblem<QuadraticProblem> quadratic;
+    HessianVectorProductProblem<Sphere> sphere;
+
+    for (TestProblem *prob : std::vector<TestProblem *>{&quadratic, &sphere})
+    {
+        INFO("problem " + prob->name());
+        TestProblem::TVector x = TestProblem::TVector::Random(prob->size());
+        minimize_and_check(solver_params, *prob, x, linear_solver_params);
+    }
+
+    CHECK(quadratic.n_assembled == 0);
+    CHECK(sphere.n_assembled == 0);
+
+    // Direct solvers need the assembled Hessian
+    linear_solver_params["solver"] = "Eigen::SimplicialLDLT";
+    CHECK_THROWS(create_solver(solver_params, linear_solver_params));
+}
+
+TEST_CASE("nonlinear-trust-region-newton-cg", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "TrustRegionNewtonCG";
+    solver_params["max_iterations"] = 1000;
+
+    // x_i = 0 and x_{i+1} = 1 make the Hessian indefinite at the start
+    HessianVectorProductProblem<Rosenbrock> prob;
+    TestProblem::TVector x(prob.size());
+    for (int i = 0; i < x.size(); ++i)
+        x(i) = i % 2;
+
+    const auto solver = minimize_and_check(solver_params, prob, x);
+    CHECK(prob.n_assembled == 0);
+
+    const json &cg_info = solver->get_info()["internal_solver"];
+    const auto terminated_by = [&](const std::string &termination) {
+        return std::any_of(cg_info.begin(), cg_info.end(), [&](const json &info) { return info["termination"] == termination; });
+    };
+    CHECK(terminated_by("negative curvature"));
+    CHECK(terminated_by("trust region boundary"));
+}
+
+TEST_CASE("nonlinear-trust-region-handle-error", "[solver]")
+{
+    const json solver_params = R"({"TrustRegionNewtonCG": {"initial_radius": 1, "max_radius": 1000, "max_cg_iterations": 100}})"_json;
+    TrustRegionNewtonCG strategy(solver_params, 1, test_logger());
+
+    // The Newton step of length √14 is cut at the boundary of the trust region
+    HessianVectorProductProblem<QuadraticProblem> prob;
+    const TestProblem::TVector x = TestProblem::TVector::Zero(prob.size());
+    TestProblem::TVector grad, direction;
+    prob.gradient(x, grad);
+    strategy.reset(prob.size());
+
+    // Retrying from the same x after an error shrinks the radius, until it is below its minimum
+    double radius = 1;
+    int retries = 0;
+    do
+    {
+        REQUIRE(strategy.compute_update_direction(prob, x, grad, direction));
+        CHECK(direction.norm() == Approx(radius));
+        CHECK(direction.dot(grad) < 0);
+        radius *= 0.25;
+        ++retries;
+    } while (strategy.handle_error());
+
+    CHECK(retries > 1);
+    CHECK(radius < 1e-8);
+
+    json info;
+    strategy.update_solver_info(info, 1);
+    REQUIRE(info["internal_solver"].size() == retries);
+    for (const auto &cg_info : info["internal_solver"])
+        CHECK(cg_info["termination"] == "trust region boundary");
+
+    // At a stationary point the direction is zero instead of nan
+    const TestProblem::TVector solution = prob.solutions()[0];
+    prob.gradient(solution, grad);
+    strategy.reset(prob.size());
+    REQUIRE(strategy.compute_update_direction(prob, solution, grad, direction));
+    CHECK(direction.norm() == 0);
+    CHECK(prob.n_assembled == 0);
+}
+
+TEST_CASE("nonlinear-regularized-newton-retry", "[solver]")
+{
+    const json solver_params = R"({
+        "matrix_free": false,
+        "RegularizedNewton": {
+            "residual_tolerance": 1e-5,
+            "forcing_term": 0,
+            "max_forcing_term": 0.9,
+            "reg_weight_min": 0.5,
+            "reg_weight_max": 1000,
+            "reg_weight_inc": 4
+        }
+    })"_json;
+
+    // Eigen::SimplicialLDLT shifts the Hessian itself, Eigen::SparseLU relies on the shift of the padded diagonal
+    for (const std::string linear_solver : {"Eigen::SimplicialLDLT", "Eigen::SparseLU"})
+    {
+        INFO("linear solver: " << linear_solver);
+        json linear_solver_params;
+        linear_solver_params["solver"] = linear_solver;
+        RegularizedNewton strategy(/*sparse=*/true, /*project_to_psd=*/false, solver_params, linear_solver_params, 1, test_logger());
+
+        SaddleProblem prob;
+        TestProblem::TVector x = TestProblem::TVector::Zero(2);
+        TestProblem::TVector grad, direction = TestProblem::TVector::Zero(2);
+        prob.gradient(x, grad);
+        strategy.reset(x.size());
+
+        // (H + wI) Δx = -g with H = [0 1; 1 0]
+        const auto check_direction = [&](const double w) {
+            Eigen::Matrix2d regularized;
+            regularized << w, 1, 1, w;
+            const TestProblem::TVector expected = regularized.inverse() * -grad;
+            CHECK((direction - expected).norm() < 1e-10);
+        };
+
+        // The retries after an error increase the regularization at the same x
+        REQUIRE(strategy.compute_update_direction(prob, x, grad, direction));
+        check_direction(0.5);
+
+        REQUIRE(strategy.handle_error());
+        REQUIRE(strategy.compute_update_direction(prob, x, grad, direction));
+        check_direction(2);
+
+        REQUIRE(strategy.handle_error());
+        REQUIRE(strategy.compute_update_direction(prob, x, grad, direction));
+        check_direction(8);
+
+        // The Hessian is only assembled once per x
+        CHECK(prob.n_assembled == 1);
+
+        x << 1, 2;
+        prob.gradient(x, grad);
+        REQUIRE(strategy.compute_update_direction(prob, x, grad, direction));
+        check_direction(8);
+        CHECK(prob.n_assembled == 2);
+    }
+}
+
+TEST_CASE("nonlinear-modified-newton", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "ModifiedNewton";
+    solver_params["max_iterations"] = 200;
+
+    Rosenbrock prob;
+
+    for (const bool secant_update : {false, true})
+    {
+        solver_params["ModifiedNewton"]["secant_update"] = secant_update;
+        INFO("secant update: " << secant_update);
+
+        // Close to the solution, where the Hessian changes slowly
+        TestProblem::TVector x = TestProblem::TVector::Ones(prob.size()) + 0.05 * TestProblem::TVector::Random(prob.size());
+        const auto solver = minimize_and_check(solver_params, prob, x);
+
+        const json &info = solver->get_info();
+        CHECK(info["factorizations"].get<int>() < info["iterations"].get<int>());
+    }
+}
+
+TEST_CASE("nonlinear-bfgs", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "BFGS";
+    solver_params["max_iterations"] = 1000;
+
+    Rosenbrock prob;
+
+    for (const int compact_history : {0, 6})
+    {
+        solver_params["BFGS"]["compact_history"] = compact_history;
+        INFO("compact history: " << compact_history);
+
+        TestProblem::TVector x = TestProblem::TVector::Zero(prob.size());
+        minimize_and_check(solver_params, prob, x);
+
+        CHECK((x - TestProblem::TVector::Ones(prob.size())).norm() < 1e-5);
+    }
+}
+
+TEST_CASE("nonlinear-preconditioned-lbfgs", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "L-BFGS";
+    solver_params["max_iterations"] = 1000;
+
+    Rosenbrock prob;
+
+    int unpreconditioned_iterations = 0;
+    for (const int refresh : {0, 1, 5})
+    {
+        solver_params["L-BFGS"]["preconditioner_refresh"] = refresh;
+        INFO("preconditioner refresh: " << refresh);
+
+        // Close to the solution, where the Hessian is positive definite
+        TestProblem::TVector x = TestProblem::TVector::Ones(prob.size()) + 0.2 * TestProblem::TVector::LinSpaced(prob.size(), -1, 1);
+        const auto solver = minimize_and_check(solver_params, prob, x);
+
+        const json &info = solver->get_info();
+        const int iterations = info["iterations"];
+        if (refresh == 0)
+        {
+            unpreconditioned_iterations = iterations;
+        }
+        else
+        {
+            CHECK(iterations < unpreconditioned_iterations);
+            CHECK(info["factorizations"].get<int>() <= iterations / refresh + 1);
+        }
+    }
+}
+
+TEST_CASE("nonlinear-nonmonotone-line-search", "[solver]")
+{
+    json solver_params;
+    solver_params["max_iterations"] = 1000;
+    solver_params["line_search"]["method"] = "NonmonotoneArmijo";
+
+    Rosenbrock prob;
+
+    for (const std::string solver_name : {"Newton", "L-BFGS"})
+    {
+        solver_params["solver"] = solver_name;
+        for (const std::string reference : {"max", "average"})
+        {
+            solver_params["line_search"]["NonmonotoneArmijo"]["reference"] = reference;
+            INFO("solver: " << solver_name << " reference: " << reference);
+
+            // Minimize twice with the same solver, the history must not carry over
+            const auto solver = create_solver(solver_params);
+            for (int i = 0; i < 2; ++i)
+            {
+                TestProblem::TVector x = TestProblem::TVector::Zero(prob.size());
+                minimize_and_check(*solver, prob, x);
+            }
+        }
+    }
+}
+
+TEST_CASE("nonlinear-interpolating-line-search", "[solver]")
+{
+    json solver_params;
+    solver_params["solver"] = "GradientDescent";
+    solver_params["max_iterations"] = 100;
+    solver_params["allow_out_of_iterations"] = true;
+
+    // Gradient descent on Rosenbrock needs many backtracking steps per iteration
+    std::vector<double> energies_per_iteration;
+    for (const std::string ls : {"Armijo", "InterpolatingArmijo"})
+    {
+        solver_params["line_search"]["method"] = ls;
+
+        EnergyCountingProblem<Rosenbrock> prob;
+        TestProblem::TVector x = TestProblem::TVector::Zero(prob.size());
+
+        const auto solver = create_solver(solver_params);
+        solver->minimize(prob, x);
+
+        const json &info = solver->get_info();
+        energies_per_iteration.push_back(prob.n_energy / info["iterations"].get<double>());
+
+        INFO("line search: " << ls);
+        CHECK(prob.value(x) < prob.value(TestProblem::TVector::Zero(prob.size())));
+    }
+
+    CHECK(energies_per_iteration[1] < energies_per_iteration[0]);
+}
+
+TEST_CASE("nonlinear-parallel-line-search", "[solver]")
+{
+    json solver_params;
+    solver_params["max_iterations"] = 100;
+    solver_params["allow_out_of_iterations"] = true;
+
+    // Batches of trial steps must accept the same steps as the serial line search
+    for (const std::string solver_name : {"GradientDescent", "Newton"})
+    {
+        for (const std::string ls : {"Armijo", "RobustArmijo", "Backtracking"})
+        {
+            solver_params["solver"] = solver_name;
+            solver_params["line_search"]["method"] = ls;
+            INFO("solver: " << solver_name << " line search: " << ls);
+
+            std::vector<TestProblem::TVector> results;
+            std::vector<int> iterations;
+            for (const int parallel_trials : {1, 4})
+            {
+                solver_params["line_search"]["parallel_trials"] = parallel_trials;
+
+                ThreadSafeProblem<Rosenbrock> prob;
+                TestProblem::TVector x = TestProblem::TVector::Zero(prob.size());
+
+                const auto solver = create_solver(solver_params);
+                solver->minimize(prob, x);
+
+                results.push_back(x);
+                iterations.push_back(solver->get_info()["iterations"]);
+
+                CHECK((prob.n_trial_solution_changed > 0) == (parallel_trials > 1));
+                CHECK(prob.n_missing_state == 0);
+            }
+
+            CHECK(iterations[0] == iterations[1]);
+            CHECK((results[0] - results[1]).norm() == 0);
+            CHECK(Rosenbrock().value(results[1]) < Rosenbrock().value(TestProblem::TVector::Zero(results[1].size())));
+        }
+    }
+}
+
 TEST_CASE("nonlinear-gradient-fd", "[solver]")
 {
     test_solvers_gradient_fd(false);